@@ -6,12 +6,17 @@
 #include <vector>
 #include <utility>
 #include <climits>
+#include <algorithm>
+#include <map>
+#include <array>
+#include <random>
+#include <chrono>
+#include <cstring>
 
 #include "utilities.hpp"
 
 using Direction = std::string;
 using Directions = std::vector<Direction>;
-using Coordinates = std::vector<Coordinate>;
 
 
 std::pair<Directions, Directions> getInput () {
@@ -21,98 +26,173 @@ std::pair<Directions, Directions> getInput () {
     return wires;
 }
 
-Coordinates findCoordinates (Directions const& dirs) {
-    Coordinates coords;
-    coords.push_back ({0, 0});
+// One straight piece of a wire.
+// It covers positions low..high along its own axis, at position fixed on the other axis,
+//   and the wire enters it at position entry after having taken steps steps.
+struct Segment {
+    bool horizontal;
+    long long fixed;
+    long long low;
+    long long high;
+    long long entry;
+    long long steps;
+
+    inline long long stepsTo (long long position) const { return steps + std::abs (position - entry); }
+};
+
+using Wire = std::vector<Segment>;
+
+Wire getWire (Directions const& dirs) {
+    Wire wire;
+    long long row {0}, col {0}, steps {0};
     for (Direction const& dir : dirs) {
-        if(dir.front () == 'R') {
-            coords.push_back ({coords.back ().row, coords.back ().col + std::stoi (dir.substr (1))});
+        long long length = std::stoll (dir.substr (1));
+        Segment segment;
+        segment.steps = steps;
+        if (dir.front () == 'R' || dir.front () == 'L') {
+            long long next = col + (dir.front () == 'R' ? length : -length);
+            segment = {true, row, std::min (col, next), std::max (col, next), col, steps};
+            col = next;
         }
-        else if (dir.front () == 'D') {
-            coords.push_back ({coords.back ().row + std::stoi (dir.substr (1)), coords.back ().col});
-        }
-        else if (dir.front () == 'L') {
-            coords.push_back ({coords.back ().row, coords.back ().col - std::stoi (dir.substr (1))});
-        }
-        else if (dir.front () == 'U') {
-            coords.push_back ({coords.back ().row - std::stoi (dir.substr (1)), coords.back ().col});
+        else if (dir.front () == 'D' || dir.front () == 'U') {
+            long long next = row + (dir.front () == 'D' ? length : -length);
+            segment = {false, col, std::min (row, next), std::max (row, next), row, steps};
+            row = next;
         }
         else {
             throw std::runtime_error ("Unknown direction " + dir);
         }
+        wire.push_back (segment);
+        steps += length;
     }
-    return coords;
+    return wire;
 }
 
-inline unsigned int manhattanDistance (Coordinate const& c1, Coordinate const& c2) {
-    return std::abs (c1.row - c2.row) + std::abs (c1.col - c2.col);
-}
+struct Crossings {
+    long long closest {LLONG_MAX};
+    long long fewestSteps {LLONG_MAX};
+};
 
-std::vector<std::pair<Coordinate, unsigned int>> findIntersections (Coordinates const& wire1, Coordinates const& wire2) {
-    std::vector<std::pair<Coordinate, unsigned int>> result;
-    unsigned int wire1Length {0U};
-    Coordinate prevWire1 = wire1.front ();
-    for (unsigned int index1 {1U}; index1 < wire1.size (); ++index1) {
-        Coordinate currWire1 = wire1.at (index1);
-        Coordinate prevWire2 = wire2.front ();
-        unsigned int wire2Length {0U};
-        for (unsigned int index2 {1U}; index2 < wire2.size (); ++index2) {
-            Coordinate currWire2 = wire2.at (index2);
-            if (prevWire1.row == currWire1.row && prevWire2.col == currWire2.col) {
-                // first is horizontal, second is vertical
-                if (prevWire1.row >= std::min (prevWire2.row, currWire2.row) && prevWire1.row <= std::max (prevWire2.row, currWire2.row)) {
-                    if (prevWire2.col >= std::min (prevWire1.col, currWire1.col) && prevWire2.col <= std::max (prevWire1.col, currWire1.col)) {
-                        if (prevWire1.row != 0 || prevWire2.col != 0) {
-                            Coordinate inter {prevWire1.row, prevWire2.col};
-                            result.push_back ({inter, wire1Length + wire2Length + manhattanDistance (prevWire1, inter) + manhattanDistance (prevWire2, inter)});
-                        }
-                    }
-                }
-            }
-            else if(prevWire1.col == currWire1.col && prevWire2.row == currWire2.row) {
-                // first is vertical, second is horizontal
-                if (prevWire1.col >= std::min (prevWire2.col, currWire2.col) && prevWire1.col <= std::max (prevWire2.col, currWire2.col)) {
-                    if (prevWire2.row >= std::min (prevWire1.row, prevWire2.row) && prevWire2.row <= std::max (prevWire1.row, currWire1.row)) {
-                        if (prevWire2.row != 0 || prevWire1.col != 0) {
-                            Coordinate inter {prevWire2.row, prevWire1.col};
-                            result.push_back ({inter, wire1Length + wire2Length + manhattanDistance (prevWire1, inter) + manhattanDistance (prevWire2, inter)});
-                        }
-                    }
-                }
+// Finds everywhere a horizontal segment of one wire crosses a vertical segment of the other, except the origin.
+// Sweeps left to right: each horizontal segment is live between its ends, kept in a tree ordered by row,
+//   and each vertical segment asks the tree for the live rows within its span.
+// Segments lying along each other are left to overlapCrossings.
+void sweepCrossings (Wire const& horizontalWire, Wire const& verticalWire, Crossings& crossings) {
+    enum EventType { START = 0, CROSS = 1, END = 2 };
+    struct Event {
+        long long col;
+        EventType type;
+        std::size_t segment;
+        bool operator< (Event const& other) const { return col != other.col ? col < other.col : type < other.type; }
+    };
+    std::vector<Event> events;
+    for (std::size_t index {0U}; index < horizontalWire.size (); ++index) {
+        if (horizontalWire[index].horizontal) {
+            events.push_back ({horizontalWire[index].low, START, index});
+            events.push_back ({horizontalWire[index].high, END, index});
+        }
+    }
+    for (std::size_t index {0U}; index < verticalWire.size (); ++index) {
+        if (!verticalWire[index].horizontal) {
+            events.push_back ({verticalWire[index].fixed, CROSS, index});
+        }
+    }
+    std::sort (events.begin (), events.end ());
+
+    std::multimap<long long, std::size_t> live;
+    std::vector<std::multimap<long long, std::size_t>::iterator> where (horizontalWire.size ());
+    for (Event const& event : events) {
+        if (event.type == START) {
+            where[event.segment] = live.insert ({horizontalWire[event.segment].fixed, event.segment});
+        }
+        else if (event.type == END) {
+            live.erase (where[event.segment]);
+        }
+        else {
+            Segment const& vertical = verticalWire[event.segment];
+            for (auto found = live.lower_bound (vertical.low); found != live.end () && found->first <= vertical.high; ++found) {
+                long long row = found->first;
+                long long col = vertical.fixed;
+                if (row == 0 && col == 0) { continue; }
+                Segment const& horizontal = horizontalWire[found->second];
+                crossings.closest = std::min (crossings.closest, std::abs (row) + std::abs (col));
+                crossings.fewestSteps = std::min (crossings.fewestSteps, horizontal.stepsTo (col) + vertical.stepsTo (row));
             }
-            wire2Length += manhattanDistance (prevWire2, currWire2);
-            prevWire2 = currWire2;
         }
-        wire1Length += manhattanDistance (prevWire1, currWire1);
-        prevWire1 = currWire1;
     }
-    return result;
 }
 
-
-unsigned int minManhattanDistance (std::vector<std::pair<Coordinate, unsigned int>> const& intersections) {
-    unsigned int lowest = UINT_MAX;
-    for (std::pair<Coordinate, unsigned int> const& pair : intersections) {
-        unsigned int dist = std::abs (pair.first.row) + std::abs (pair.first.col);
-        lowest = std::min (lowest, dist);
+// Finds everywhere segments of the two wires lie along the same line and overlap, except the origin.
+// Along the overlap both step counts change by one per position, so their sum is least at one end of it,
+//   or one position in from that end if the end is the origin.
+void overlapCrossings (Wire const& wire1, Wire const& wire2, bool horizontal, Crossings& crossings) {
+    std::vector<std::pair<Segment const*, int>> lined;
+    for (Segment const& segment : wire1) { if (segment.horizontal == horizontal) { lined.push_back ({&segment, 0}); } }
+    for (Segment const& segment : wire2) { if (segment.horizontal == horizontal) { lined.push_back ({&segment, 1}); } }
+    std::sort (lined.begin (), lined.end (), [] (auto const& x, auto const& y) {
+        return x.first->fixed != y.first->fixed ? x.first->fixed < y.first->fixed : x.first->low < y.first->low;
+    });
+    // The segments of each wire on the current line that might still overlap later ones.
+    std::array<std::vector<Segment const*>, 2> open;
+    for (std::size_t index {0U}; index < lined.size (); ++index) {
+        Segment const& segment = *lined[index].first;
+        if (index == 0U || lined[index - 1].first->fixed != segment.fixed) {
+            open[0].clear ();
+            open[1].clear ();
+        }
+        std::vector<Segment const*>& others = open[1 - lined[index].second];
+        others.erase (std::remove_if (others.begin (), others.end (), [&] (Segment const* other) { return other->high < segment.low; }), others.end ());
+        for (Segment const* other : others) {
+            long long low = segment.low;
+            long long high = std::min (segment.high, other->high);
+            for (long long position : {low, high, low + 1, high - 1, 0LL, -1LL, 1LL}) {
+                if (position < low || position > high || (segment.fixed == 0 && position == 0)) { continue; }
+                crossings.closest = std::min (crossings.closest, std::abs (segment.fixed) + std::abs (position));
+                crossings.fewestSteps = std::min (crossings.fewestSteps, segment.stepsTo (position) + other->stepsTo (position));
+            }
+        }
+        open[lined[index].second].push_back (&segment);
     }
-    return lowest;
 }
 
-unsigned int minLength (std::vector<std::pair<Coordinate, unsigned int>> const& intersections) {
-    unsigned int lowest = UINT_MAX;
-    for (std::pair<Coordinate, unsigned int> const& pair : intersections) {
-        lowest = std::min (lowest, pair.second);
-    }
-    return lowest;
+Crossings findCrossings (Wire const& wire1, Wire const& wire2) {
+    Crossings crossings;
+    sweepCrossings (wire1, wire2, crossings);
+    sweepCrossings (wire2, wire1, crossings);
+    overlapCrossings (wire1, wire2, true, crossings);
+    overlapCrossings (wire1, wire2, false, crossings);
+    return crossings;
+}
+
+// Two random wires of segments turns each, every segment up to length long.
+void benchmark (std::size_t segments, long long length) {
+    std::mt19937_64 generator {2019U};
+    std::uniform_int_distribution<long long> lengths {1, length};
+    std::uniform_int_distribution<int> turns {0, 1};
+    auto randomWire = [&] () {
+        Directions dirs;
+        for (std::size_t index {0U}; index < segments; ++index) {
+            char const* choices = index % 2 == 0 ? "RL" : "DU";
+            dirs.push_back (choices[turns (generator)] + std::to_string (lengths (generator)));
+        }
+        return getWire (dirs);
+    };
+    Wire wire1 = randomWire ();
+    Wire wire2 = randomWire ();
+    auto start = std::chrono::steady_clock::now ();
+    Crossings crossings = findCrossings (wire1, wire2);
+    std::chrono::duration<double> elapsed {std::chrono::steady_clock::now () - start};
+    std::cout << crossings.closest << "\n" << crossings.fewestSteps << "\n" << elapsed.count () << " seconds\n";
 }
 
-int main () {
+int main (int argc, char* argv[]) {
+    if (argc > 3 && std::strcmp (argv[1], "--benchmark") == 0) {
+        benchmark (std::stoul (argv[2]), std::stoll (argv[3]));
+        return 0;
+    }
     std::pair<Directions, Directions> dirs = getInput ();
-    Coordinates wire1 = findCoordinates (dirs.first);
-    Coordinates wire2 = findCoordinates (dirs.second);
-    std::vector<std::pair<Coordinate, unsigned int>> intersections = findIntersections (wire1, wire2);
-    std::cout << minManhattanDistance (intersections) << "\n";
-    std::cout << minLength (intersections) << "\n";
+    Crossings crossings = findCrossings (getWire (dirs.first), getWire (dirs.second));
+    std::cout << crossings.closest << "\n";
+    std::cout << crossings.fewestSteps << "\n";
     return 0;
 }
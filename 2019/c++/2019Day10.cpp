@@ -7,11 +7,14 @@
 #include <vector>
 #include <cmath>
 #include <cassert>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
 
 #include "utilities.hpp"
 
 using AsteroidField = std::vector<std::vector<bool>>;
-using DetectedCounts = std::vector<std::vector<unsigned int>>;
 
 
 AsteroidField getInput () {
@@ -40,171 +43,139 @@ int greatestCommonDivisor (int x, int y) {
     return larger;
 }
 
-unsigned int countDetections (AsteroidField const& field, unsigned int origRow, unsigned int origCol) {
-    unsigned int count {0U};
-    for (unsigned int row {0U}; row < field.size (); ++row) {
-        for (unsigned int col {0U}; col < field.at (row).size (); ++col) {
-            if (field.at (row).at (col) && (row != origRow || col != origCol)) {
-                int rowDiff = (int)row - (int)origRow;
-                int colDiff = (int)col - (int)origCol;
-                if (rowDiff == 0) { colDiff /= std::abs (colDiff); }
-                else if (colDiff == 0) { rowDiff /= std::abs (rowDiff); }
-                else {
-                    int gcd = greatestCommonDivisor (std::abs (rowDiff), std::abs (colDiff));
-                    rowDiff /= gcd;
-                    colDiff /= gcd;
-                }
-                bool hit = false;
-                int r = (int)origRow + rowDiff;
-                int c = (int)origCol + colDiff;
-                while (!(r == (int)row && c == (int)col) && !hit) {
-                    if (field.at (r).at (c)) { hit = true; }
-                    r += rowDiff;
-                    c += colDiff;
-                }
-                if (!hit) { ++count; }
-            }
+std::vector<Coordinate> getAsteroids (AsteroidField const& field) {
+    std::vector<Coordinate> asteroids;
+    for (int row {0}; row < (int)field.size (); ++row) {
+        for (int col {0}; col < (int)field.at (row).size (); ++col) {
+            if (field[row][col]) { asteroids.push_back ({row, col}); }
         }
     }
-    return count;
+    return asteroids;
 }
 
-DetectedCounts countDetections (AsteroidField const& field) {
-    DetectedCounts counts;
-    for (unsigned int row {0U}; row < field.size (); ++row) {
-        std::vector<unsigned int> count;
-        for (unsigned int col {0U}; col < field.at (row).size (); ++col) {
-            if (field.at (row).at (col)) {
-                count.push_back (countDetections (field, row, col));
-            }
-            else {
-                count.push_back (0U);
-            }
-        }
-        counts.push_back (count);
-    }
-    return counts;
+// The direction from one asteroid to another, reduced so that everything along the same line has the same one.
+inline Coordinate getDirection (Coordinate const& from, Coordinate const& to) {
+    int rowDiff = to.row - from.row;
+    int colDiff = to.col - from.col;
+    int gcd = greatestCommonDivisor (std::abs (rowDiff), std::abs (colDiff));
+    return {rowDiff / gcd, colDiff / gcd};
 }
 
-std::pair<unsigned int, std::pair<int, int>> maxDetectionCount (DetectedCounts const& counts) {
-    std::pair<unsigned int, std::pair<int, int>> largest {0U, {0, 0}};
-    for (unsigned int row {0U}; row < counts.size (); ++row) {
-        for (unsigned int col {0U}; col < counts.at (row).size (); ++col) {
-            if (counts.at (row).at (col) > largest.first) {
-                largest = {counts.at (row).at (col), {row, col}};
+inline std::uint64_t packDirection (Coordinate const& direction) {
+    return ((std::uint64_t)(std::uint32_t)direction.row << 32) | (std::uint32_t)direction.col;
+}
+
+// For every offset that fits in the field, the index of its reduced direction, so that grouping asteroids by
+//   direction needs neither a gcd nor a hash per pair.
+struct DirectionTable {
+    int rows;
+    int cols;
+    std::vector<std::uint32_t> reduced;
+
+    DirectionTable (int fieldRows, int fieldCols) : rows {fieldRows}, cols {fieldCols}, reduced ((2 * rows - 1) * (2 * cols - 1)) {
+        for (int rowDiff {1 - rows}; rowDiff < rows; ++rowDiff) {
+            for (int colDiff {1 - cols}; colDiff < cols; ++colDiff) {
+                if (rowDiff == 0 && colDiff == 0) { continue; }
+                reduced[indexOf (rowDiff, colDiff)] = indexOf (getDirection ({0, 0}, {rowDiff, colDiff}));
             }
         }
     }
-    return largest;
-}
 
-double computeAngle (int origRow, int origCol, int row, int col) {
-    double colDiff = (col - origCol);
-    double rowDiff = (row - origRow);
-    if (rowDiff <= 0 && colDiff >= 0) {
-        // first quadrant
-        return atan (std::abs (colDiff / rowDiff)) * 180 / M_PI;
-    }
-    else if (rowDiff > 0 && colDiff > 0) {
-        // second quadrant
-        return atan (std::abs (rowDiff / colDiff)) * 180 / M_PI + 90;
+    inline std::uint32_t indexOf (int rowDiff, int colDiff) const {
+        return (rowDiff + rows - 1) * (2 * cols - 1) + (colDiff + cols - 1);
     }
-    else if (rowDiff >= 0 && colDiff <= 0) {
-        // third quadrant
-        return atan (std::abs (colDiff / rowDiff)) * 180 / M_PI + 180;
+
+    inline std::uint32_t indexOf (Coordinate const& direction) const {
+        return indexOf (direction.row, direction.col);
     }
-    else if(rowDiff < 0 && colDiff < 0) {
-        // fourth quadrant
-        return atan (std::abs (rowDiff / colDiff)) * 180 / M_PI + 270;
+
+    inline std::uint32_t directionBetween (Coordinate const& from, Coordinate const& to) const {
+        return reduced[indexOf (to.row - from.row, to.col - from.col)];
     }
-    else {
-        return -1;
+};
+
+// An asteroid can see exactly one other asteroid in each direction that has any.  Each direction seen is marked with
+//   a stamp unique to this station, so the marks never need clearing.
+unsigned int countVisible (std::vector<Coordinate> const& asteroids, std::size_t station, DirectionTable const& table, std::vector<std::uint32_t> & seen) {
+    std::uint32_t const stamp = station + 1U;
+    unsigned int count {0U};
+    for (std::size_t index {0U}; index < asteroids.size (); ++index) {
+        if (index == station) { continue; }
+        std::uint32_t & mark = seen[table.directionBetween (asteroids[station], asteroids[index])];
+        if (mark != stamp) {
+            mark = stamp;
+            ++count;
+        }
     }
+    return count;
 }
 
-std::vector<std::vector<double>> findAngles (AsteroidField const& field, int origRow, int origCol) {
-    std::vector<std::vector<double>> angles;
-    for (int row {0}; row < (int)field.size (); ++row ) {
-        std::vector<double> vec;
-        for (int col {0}; col < (int)field.at (row).size (); ++col) {
-            if (field.at (row).at (col) && !(row == origRow && col == origCol)) {
-                vec.push_back (computeAngle (origRow, origCol, row, col));
-            }
-            else {
-                vec.push_back (-1.0);
-            }
+std::pair<unsigned int, std::pair<int, int>> findBestStation (AsteroidField const& field, std::vector<Coordinate> const& asteroids) {
+    DirectionTable const table (field.size (), field.empty () ? 0 : field[0].size ());
+    std::vector<unsigned int> counts (asteroids.size ());
+    std::vector<std::vector<std::uint32_t>> seen (workerCount (), std::vector<std::uint32_t> (table.reduced.size (), 0U));
+    forEachIndex (asteroids.size (), [&] (std::size_t station, unsigned int thread) {
+        counts[station] = countVisible (asteroids, station, table, seen[thread]);
+    });
+    std::pair<unsigned int, std::pair<int, int>> largest {0U, {0, 0}};
+    for (std::size_t station {0U}; station < asteroids.size (); ++station) {
+        if (counts[station] > largest.first) {
+            largest = {counts[station], {asteroids[station].row, asteroids[station].col}};
         }
-        angles.push_back (vec);
     }
-    return angles;
+    return largest;
 }
 
-void testAngles () {
-    std::cout << "These should be strictly increasing.\n";
-    std::cout << "Angle to (3,5) is " << computeAngle (5, 5, 3, 5) << "\n";
-    std::cout << "Angle to (3,6) is " << computeAngle (5, 5, 3, 6) << "\n";
-    std::cout << "Angle to (3,7) is " << computeAngle (5, 5, 3, 7) << "\n";
-    std::cout << "Angle to (4,7) is " << computeAngle (5, 5, 4, 7) << "\n";
-    std::cout << "Angle to (5,6) is " << computeAngle (5, 5, 5, 6) << "\n";
-    std::cout << "Angle to (6,7) is " << computeAngle (5, 5, 6, 7) << "\n";
-    std::cout << "Angle to (7,7) is " << computeAngle (5, 5, 7, 7) << "\n";
-    std::cout << "Angle to (7,6) is " << computeAngle (5, 5, 7, 6) << "\n";
-    std::cout << "Angle to (6,5) is " << computeAngle (5, 5, 6, 5) << "\n";
-    std::cout << "Angle to (7,4) is " << computeAngle (5, 5, 7, 4) << "\n";
-    std::cout << "Angle to (7,3) is " << computeAngle (5, 5, 7, 3) << "\n";
-    std::cout << "Angle to (6,3) is " << computeAngle (5, 5, 6, 3) << "\n";
-    std::cout << "Angle to (5,4) is " << computeAngle (5, 5, 5, 4) << "\n";
-    std::cout << "Angle to (4,3) is " << computeAngle (5, 5, 4, 3) << "\n";
-    std::cout << "Angle to (3,3) is " << computeAngle (5, 5, 3, 3) << "\n";
-    std::cout << "Angle to (3,4) is " << computeAngle (5, 5, 3, 4) << "\n";
+// Whether direction a comes strictly before direction b going clockwise from straight up, compared exactly.
+bool clockwiseBefore (Coordinate const& a, Coordinate const& b) {
+    // Directions from straight up to just before straight down are the first half of the turn.
+    bool aSecondHalf = a.col < 0 || (a.col == 0 && a.row > 0);
+    bool bSecondHalf = b.col < 0 || (b.col == 0 && b.row > 0);
+    if (aSecondHalf != bSecondHalf) { return bSecondHalf; }
+    // With rows increasing downward, b is clockwise of a when this cross product is positive.
+    return (long long)a.col * b.row - (long long)a.row * b.col > 0;
 }
 
-std::pair<double, std::pair<int, int>> nextOneToVaporize (AsteroidField const& field, std::vector<std::vector<double>> const& angles, int origRow, int origCol, double prevAngle) {
-    std::pair<double, std::pair<int, int>> result {360, {0, 0}};
-    for (int row {0}; row < (int)field.size (); ++row) {
-        for (int col {0}; col < (int)field.at (row).size (); ++col) {
-            if (field.at (row).at (col)) {
-                if (angles.at (row).at (col) > prevAngle) {
-                    if (angles.at (row).at (col) < result.first) {
-                        // found a lower angle than we had found before
-                        result = {angles.at (row).at (col), {row, col}};
-                    }
-                    else if(angles.at (row).at (col) == result.first) {
-                        if (std::abs (origRow - row) + std::abs (origCol - col) < std::abs (origRow - result.second.first) + std::abs (origCol - result.second.second)) {
-                            // found a closer asteroid at same angle we had found before
-                            result = {angles.at (row).at (col), {row, col}};
-                        }
-                    }
-                }
-            }
+// Sorts the other asteroids into one queue per direction, nearest first, and takes one from each queue per rotation.
+std::vector<Coordinate> getVaporizationOrder (std::vector<Coordinate> const& asteroids, Coordinate const& station) {
+    std::unordered_map<std::uint64_t, std::size_t> bucketIndices;
+    std::vector<Coordinate> directions;
+    std::vector<std::vector<Coordinate>> buckets;
+    for (Coordinate const& asteroid : asteroids) {
+        if (asteroid == station) { continue; }
+        Coordinate direction = getDirection (station, asteroid);
+        auto inserted = bucketIndices.insert ({packDirection (direction), buckets.size ()});
+        if (inserted.second) {
+            directions.push_back (direction);
+            buckets.push_back ({});
         }
+        buckets[inserted.first->second].push_back (asteroid);
     }
-    return result;
-}
-
-int get200thVaporization (AsteroidField & field, std::vector<std::vector<double>> & angles, int origRow, int origCol) {
-    double prevAngle = -0.5;
-    std::pair<double, std::pair<int, int>> result;
-    for (unsigned int count {0U}; count < 200U; ++count) {
-        result = nextOneToVaporize (field, angles, origRow, origCol, prevAngle);
-        if (result.first == 360) {
-            prevAngle = -0.5;
-            result = nextOneToVaporize (field, angles, origRow, origCol, prevAngle);
+    std::vector<std::size_t> order (buckets.size ());
+    std::iota (order.begin (), order.end (), 0U);
+    std::sort (order.begin (), order.end (), [&] (std::size_t x, std::size_t y) { return clockwiseBefore (directions[x], directions[y]); });
+    auto distance = [&] (Coordinate const& c) { return std::abs (c.row - station.row) + std::abs (c.col - station.col); };
+    for (std::vector<Coordinate> & bucket : buckets) {
+        std::sort (bucket.begin (), bucket.end (), [&] (Coordinate const& x, Coordinate const& y) { return distance (x) < distance (y); });
+    }
+    std::vector<Coordinate> result;
+    result.reserve (asteroids.size ());
+    for (std::size_t rotation {0U}; result.size () + 1U < asteroids.size (); ++rotation) {
+        for (std::size_t bucket : order) {
+            if (rotation < buckets[bucket].size ()) { result.push_back (buckets[bucket][rotation]); }
         }
-        assert (result.first >= 0.0 && result.first <= 360);
-        field[result.second.first][result.second.second] = false;
-        prevAngle = result.first;
     }
-    return result.second.first + result.second.second * 100;
+    return result;
 }
 
 int main () {
     AsteroidField field = getInput ();
-    DetectedCounts detectedCounts = countDetections (field);
-    std::pair<unsigned int, std::pair<int, int>> whereToBuild = maxDetectionCount (detectedCounts);
+    std::vector<Coordinate> asteroids = getAsteroids (field);
+    std::pair<unsigned int, std::pair<int, int>> whereToBuild = findBestStation (field, asteroids);
     std::cout << whereToBuild << "\n";
-    std::vector<std::vector<double>> angles = findAngles (field, whereToBuild.second.first, whereToBuild.second.second);
-    std::cout << get200thVaporization (field, angles, whereToBuild.second.first, whereToBuild.second.second) << "\n";
-    //testAngles ();
+    std::vector<Coordinate> order = getVaporizationOrder (asteroids, {whereToBuild.second.first, whereToBuild.second.second});
+    if (order.size () >= 200U) {
+        std::cout << order[199].row + order[199].col * 100 << "\n";
+    }
     return 0;
 }
@@ -6,146 +6,107 @@
 #include <cassert>
 #include <cstdio>
 #include <numeric>
+#include <vector>
+#include <thread>
 
 #include "utilities.hpp"
 
-constexpr unsigned int NUM_MOONS = 4;
 constexpr unsigned int STEPS = 1000;
 
-struct Vec3D {
-    int x, y, z;
-};
-
-struct Moon {
-    Vec3D position;
-    Vec3D velocity;
-};
-
-bool operator== (Moon const& a, Moon const& b) {
-    return a.position.x == b.position.x && a.position.y == b.position.y && a.position.z == b.position.z &&
-        a.velocity.x == b.velocity.x && a.velocity.y == b.velocity.y && a.velocity.z == b.velocity.z;
-}
+constexpr unsigned int NUM_AXES = 3;
 
-using System = std::array<Moon, NUM_MOONS>;
+// One axis of any number of moons, kept as plain arrays so that each step is simple loops over ints.
+struct Axis {
+    std::vector<int> positions;
+    std::vector<int> velocities;
 
-System getInput () {
-    System system;
-    for (unsigned int i {0U}; i < NUM_MOONS; ++i) {
-        int count = scanf ("<x=%d, y=%d, z=%d>\n", &system[i].position.x, &system[i].position.y, &system[i].position.z);
-        assert (count == 3);
-        system[i].velocity.x = 0;
-        system[i].velocity.y = 0;
-        system[i].velocity.z = 0;
+    bool operator== (Axis const& other) const {
+        return positions == other.positions && velocities == other.velocities;
     }
-    return system;
-}
+};
+
+using MoonSystem = std::array<Axis, NUM_AXES>;
 
-void printSystem (System const& system) {
-    for (unsigned int i {0U}; i < NUM_MOONS; ++i) {
-        printf ("pos=<x=%4d, y=%4d, z=%4d>, vel=<x=%4d, y=%4d, z=%4d>\n", system[i].position.x, system[i].position.y, system[i].position.z, system[i].velocity.x, system[i].velocity.y, system[i].velocity.z);
+MoonSystem getMoons () {
+    MoonSystem moons;
+    int x, y, z;
+    while (scanf (" <x=%d, y=%d, z=%d>", &x, &y, &z) == 3) {
+        moons[0].positions.push_back (x);
+        moons[1].positions.push_back (y);
+        moons[2].positions.push_back (z);
     }
+    for (Axis & axis : moons) { axis.velocities.assign (axis.positions.size (), 0); }
+    return moons;
 }
 
-void doTimeStep (System & system) {
-    for (unsigned int i {0U}; i < NUM_MOONS; ++i) {
-        for (unsigned int j {i + 1}; j < NUM_MOONS; ++j) {
-            if (system[i].position.x < system[j].position.x) {
-                ++system[i].velocity.x;
-                --system[j].velocity.x;
-            }
-            else if(system[i].position.x > system[j].position.x) {
-                --system[i].velocity.x;
-                ++system[j].velocity.x;
-            }
-            if (system[i].position.y < system[j].position.y) {
-                ++system[i].velocity.y;
-                --system[j].velocity.y;
-            }
-            else if(system[i].position.y > system[j].position.y) {
-                --system[i].velocity.y;
-                ++system[j].velocity.y;
-            }
-            if (system[i].position.z < system[j].position.z) {
-                ++system[i].velocity.z;
-                --system[j].velocity.z;
-            }
-            else if(system[i].position.z > system[j].position.z) {
-                --system[i].velocity.z;
-                ++system[j].velocity.z;
-            }
+// Every moon is pulled one unit toward every other moon; the pull is a sum of comparisons, with no branches.
+void doStep (Axis & axis, std::vector<int> & pulls) {
+    std::size_t const count = axis.positions.size ();
+    int const* positions = axis.positions.data ();
+    pulls.resize (count);
+    for (std::size_t i {0U}; i < count; ++i) {
+        int const mine = positions[i];
+        int pull {0};
+        for (std::size_t j {0U}; j < count; ++j) {
+            pull += (positions[j] > mine) - (positions[j] < mine);
         }
+        pulls[i] = pull;
     }
-    for (unsigned int i {0U}; i < NUM_MOONS; ++i) {
-        system[i].position.x += system[i].velocity.x;
-        system[i].position.y += system[i].velocity.y;
-        system[i].position.z += system[i].velocity.z;
+    for (std::size_t i {0U}; i < count; ++i) {
+        axis.velocities[i] += pulls[i];
+        axis.positions[i] += axis.velocities[i];
     }
 }
 
-System afterSeveralTimeSteps (System const& orig, unsigned int steps) {
-    System result {orig};
-    for (unsigned int x {0U}; x < steps; ++x) {
-        doTimeStep (result);
+MoonSystem afterSeveralTimeSteps (MoonSystem moons, unsigned int steps) {
+    std::vector<int> pulls;
+    for (Axis & axis : moons) {
+        for (unsigned int step {0U}; step < steps; ++step) { doStep (axis, pulls); }
     }
-    return result;
+    return moons;
 }
 
-unsigned int energyLevel (System const& system) {
+unsigned int energyLevel (MoonSystem const& moons) {
     unsigned int total {0U};
-    for (unsigned int i {0U}; i < NUM_MOONS; ++i) {
-        unsigned int potential = std::abs (system[i].position.x) + std::abs (system[i].position.y) + std::abs (system[i].position.z);
-        unsigned int kinetic = std::abs (system[i].velocity.x) + std::abs (system[i].velocity.y) + std::abs (system[i].velocity.z);
+    for (std::size_t moon {0U}; moon < moons[0].positions.size (); ++moon) {
+        unsigned int potential {0U};
+        unsigned int kinetic {0U};
+        for (Axis const& axis : moons) {
+            potential += std::abs (axis.positions[moon]);
+            kinetic += std::abs (axis.velocities[moon]);
+        }
         total += potential * kinetic;
     }
     return total;
 }
 
-using Positions1D = std::array<int, NUM_MOONS>;
-using Velocities1D = std::array<int, NUM_MOONS>;
-
-void doStep1D (Positions1D & positions, Velocities1D & velocities) {
-    for (unsigned int i {0U}; i < NUM_MOONS; ++i) {
-        for (unsigned int j {i + 1}; j < NUM_MOONS; ++j) {
-            if (positions[i] < positions[j]) {
-                ++velocities[i];
-                --velocities[j];
-            }
-            else if(positions[i] > positions[j]) {
-                --velocities[i];
-                ++velocities[j];
-            }
-        }
-    }
-    for (unsigned int i {0U}; i < NUM_MOONS; ++i) {
-        positions[i] += velocities[i];
-    }
-}
-
-unsigned long long findPeriod1D (Positions1D positions, Velocities1D velocities) {
-    Positions1D originalPos = positions;
-    Velocities1D originalVel = velocities;
+// Each step can be undone, so the first repeated state on an axis is always the starting one.
+unsigned long long findPeriod (Axis const& original) {
+    Axis axis {original};
+    std::vector<int> pulls;
     unsigned long long count {0U};
-    while (true) {
-        doStep1D (positions, velocities);
+    do {
+        doStep (axis, pulls);
         ++count;
-        if (positions == originalPos && velocities == originalVel) { break; }
-    }
+    } while (!(axis == original));
     return count;
 }
 
-
-unsigned long long findPeriod (System const& system) {
-    unsigned long long xPeriod = findPeriod1D ({system[0].position.x, system[1].position.x, system[2].position.x, system[3].position.x}, {system[0].velocity.x, system[1].velocity.x, system[2].velocity.x, system[3].velocity.x});
-    unsigned long long yPeriod = findPeriod1D ({system[0].position.y, system[1].position.y, system[2].position.y, system[3].position.y}, {system[0].velocity.y, system[1].velocity.y, system[2].velocity.y, system[3].velocity.y});
-    unsigned long long zPeriod = findPeriod1D ({system[0].position.z, system[1].position.z, system[2].position.z, system[3].position.z}, {system[0].velocity.z, system[1].velocity.z, system[2].velocity.z, system[3].velocity.z});
-    return std::lcm (std::lcm (xPeriod, yPeriod), zPeriod);
+// The axes never affect one another, so each one finds its own period on its own thread.
+unsigned long long findPeriod (MoonSystem const& moons) {
+    std::array<unsigned long long, NUM_AXES> periods;
+    std::vector<std::thread> workers;
+    for (unsigned int axis {0U}; axis < NUM_AXES; ++axis) {
+        workers.emplace_back ([&, axis] () { periods[axis] = findPeriod (moons[axis]); });
+    }
+    for (std::thread & worker : workers) { worker.join (); }
+    return std::lcm (std::lcm (periods[0], periods[1]), periods[2]);
 }
 
-
 int main () {
-    System system = getInput ();
-    System finished = afterSeveralTimeSteps (system, STEPS);
+    MoonSystem moons = getMoons ();
+    MoonSystem finished = afterSeveralTimeSteps (moons, STEPS);
     std::cout << energyLevel (finished) << "\n";
-    std::cout << findPeriod (system) << "\n";
+    std::cout << findPeriod (moons) << "\n";
     return 0;
 }
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <stdexcept>
 
 #include "utilities.hpp"
 
@@ -75,135 +77,101 @@ Cookbook getInput () {
     return cookbook;
 }
 
-std::ostream & operator<< (std::ostream & out, std::unordered_map<std::string, unsigned long> const& map) {
-    for (std::pair<std::string const, unsigned long> p : map) {
-        out << p.second << " " << p.first << " ";
-    }
-    return out;
-}
+// The cookbook with chemicals interned to indices, and an order in which every chemical comes before everything
+//   it is made from, so that by the time a chemical is reached its total need is known.
+struct Factory {
+    std::vector<std::string> names;
+    std::size_t ore;
+    std::size_t fuel;
+    std::vector<unsigned long> batchSizes;
+    std::vector<std::vector<std::pair<std::size_t, unsigned long>>> inputs;
+    std::vector<std::size_t> order;
+};
 
-unsigned long oreToMakeFuel (Cookbook const& book) {
-    std::unordered_map<std::string, unsigned long> needs;
-    std::unordered_map<std::string, unsigned long> extras;
-    unsigned long oreAmount {0UL};
-    needs.insert ({"FUEL", 1UL});
-    while (!needs.empty ()) {
-        //std::cout << "Needs: " << needs << "\n";
-        //std::cout << "Extras: " << extras << "\n";
-        std::string neededType = needs.begin ()->first;
-        unsigned long neededQuantity = needs.begin ()->second;
-        needs.erase (needs.begin ());
-        Recipe const& recipe = book.at (neededType);
-        unsigned long times = neededQuantity / recipe.output.quantity + (neededQuantity % recipe.output.quantity == 0 ? 0 : 1);
-        unsigned long surplus = times * recipe.output.quantity - neededQuantity;
-        if (surplus > 0) {
-            if (extras.count (neededType) == 0) {
-                extras.insert ({neededType, surplus});
-            }
-            else {
-                extras[neededType] += surplus;
-            }
+Factory compileFactory (Cookbook const& book) {
+    Factory factory;
+    std::unordered_map<std::string, std::size_t> indices;
+    auto intern = [&] (std::string const& name) {
+        auto inserted = indices.insert ({name, factory.names.size ()});
+        if (inserted.second) { factory.names.push_back (name); }
+        return inserted.first->second;
+    };
+    factory.ore = intern ("ORE");
+    factory.fuel = intern ("FUEL");
+    for (std::pair<std::string const, Recipe> const& entry : book) {
+        intern (entry.first);
+        for (Ingredient const& input : entry.second.inputs) { intern (input.type); }
+    }
+    factory.batchSizes.assign (factory.names.size (), 0UL);
+    factory.inputs.resize (factory.names.size ());
+    std::vector<unsigned int> consumers (factory.names.size (), 0U);
+    for (std::pair<std::string const, Recipe> const& entry : book) {
+        std::size_t output = indices.at (entry.first);
+        factory.batchSizes[output] = entry.second.output.quantity;
+        for (Ingredient const& input : entry.second.inputs) {
+            factory.inputs[output].push_back ({indices.at (input.type), input.quantity});
+            ++consumers[indices.at (input.type)];
         }
-        for (Ingredient const& component : recipe.inputs) {
-            unsigned long needed = times * component.quantity;
-            if (component.type == "ORE") {
-                oreAmount += needed;
-            }
-            else {
-                if (extras.count (component.type) == 1) {
-                    if (extras.at (component.type) > needed) {
-                        extras[component.type] = extras[component.type] - needed;
-                        needed = 0;
-                    }
-                    else {
-                        needed -= extras[component.type];
-                        extras.erase (component.type);
-                    }
-                }
-                if (needed > 0) {
-                    if (needs.count (component.type) == 0) {
-                        needs.insert ({component.type, needed});
-                    }
-                    else {
-                        needs[component.type] += needed;
-                    }
-                }
-            }
+    }
+
+    // Kahn's algorithm, starting from the chemicals nothing is made from.
+    std::vector<std::size_t> ready;
+    for (std::size_t chemical {0U}; chemical < factory.names.size (); ++chemical) {
+        if (consumers[chemical] == 0U) { ready.push_back (chemical); }
+    }
+    while (!ready.empty ()) {
+        std::size_t chemical = ready.back ();
+        ready.pop_back ();
+        factory.order.push_back (chemical);
+        for (std::pair<std::size_t, unsigned long> const& input : factory.inputs[chemical]) {
+            if (--consumers[input.first] == 0U) { ready.push_back (input.first); }
         }
     }
-    return oreAmount;
+    if (factory.order.size () != factory.names.size ()) { throw std::runtime_error ("The reactions contain a cycle."); }
+    for (std::size_t chemical {0U}; chemical < factory.names.size (); ++chemical) {
+        if (chemical != factory.ore && factory.batchSizes[chemical] == 0UL) { throw std::runtime_error ("Nothing makes " + factory.names[chemical]); }
+    }
+    return factory;
 }
 
-unsigned long howMuchFuelFromTrillionOre (Cookbook const& book) {
-    std::unordered_map<std::string, unsigned long> needs;
-    std::unordered_map<std::string, unsigned long> extras;
-    unsigned long oreAmount {0UL};
-    unsigned long fuelMade {0UL};
-    while (oreAmount <= 1'000'000'000'000) {
-        //std::cout << "Made " << fuelMade << " fuel, used " << oreAmount << " ore.\n";
-        unsigned long jump {1UL};
-        if (oreAmount < 900'000'000'000) {
-            jump = 1000UL;
-            //std::cout << "Leaping by 1000\n";
-        }
-        else if (oreAmount < 999'900'000'000) {
-            jump = 100UL;
-            //std::cout << "Jumping by 100\n";
-        }
-        needs.insert ({"FUEL", jump});
-        fuelMade += jump;
-        while (!needs.empty ()) {
-            //std::cout << "Needs: " << needs << "\n";
-            //std::cout << "Extras: " << extras << "\n";
-            std::string neededType = needs.begin ()->first;
-            unsigned long neededQuantity = needs.begin ()->second;
-            needs.erase (needs.begin ());
-            Recipe const& recipe = book.at (neededType);
-            unsigned long times = neededQuantity / recipe.output.quantity + (neededQuantity % recipe.output.quantity == 0 ? 0 : 1);
-            unsigned long surplus = times * recipe.output.quantity - neededQuantity;
-            if (surplus > 0) {
-                if (extras.count (neededType) == 0) {
-                    extras.insert ({neededType, surplus});
-                }
-                else {
-                    extras[neededType] += surplus;
-                }
-            }
-            for (Ingredient const& component : recipe.inputs) {
-                unsigned long needed = times * component.quantity;
-                if (component.type == "ORE") {
-                    oreAmount += needed;
-                }
-                else {
-                    if (extras.count (component.type) == 1) {
-                        if (extras.at (component.type) > needed) {
-                            extras[component.type] = extras[component.type] - needed;
-                            needed = 0;
-                        }
-                        else {
-                            needed -= extras[component.type];
-                            extras.erase (component.type);
-                        }
-                    }
-                    if (needed > 0) {
-                        if (needs.count (component.type) == 0) {
-                            needs.insert ({component.type, needed});
-                        }
-                        else {
-                            needs[component.type] += needed;
-                        }
-                    }
-                }
-            }
+// One pass in topological order, accumulating how much of each chemical is needed.
+unsigned long long oreToMakeFuel (Factory const& factory, unsigned long long fuel, std::vector<unsigned long long> & needs) {
+    needs.assign (factory.names.size (), 0ULL);
+    needs[factory.fuel] = fuel;
+    for (std::size_t chemical : factory.order) {
+        if (chemical == factory.ore || needs[chemical] == 0ULL) { continue; }
+        unsigned long long batches = (needs[chemical] + factory.batchSizes[chemical] - 1ULL) / factory.batchSizes[chemical];
+        for (std::pair<std::size_t, unsigned long> const& input : factory.inputs[chemical]) {
+            needs[input.first] += batches * input.second;
         }
     }
-    return fuelMade - 1;
+    return needs[factory.ore];
+}
+
+// Doubles the amount of fuel until it costs too much, then binary searches between the last two amounts.
+unsigned long long maxFuelFromOre (Factory const& factory, unsigned long long ore) {
+    std::vector<unsigned long long> needs;
+    if (oreToMakeFuel (factory, 1ULL, needs) > ore) { return 0ULL; }
+    unsigned long long low {1ULL};
+    unsigned long long high {2ULL};
+    while (oreToMakeFuel (factory, high, needs) <= ore) {
+        low = high;
+        high *= 2ULL;
+    }
+    while (high - low > 1ULL) {
+        unsigned long long middle = low + (high - low) / 2ULL;
+        if (oreToMakeFuel (factory, middle, needs) <= ore) { low = middle; }
+        else { high = middle; }
+    }
+    return low;
 }
 
 int main () {
     Cookbook book = getInput ();
     //std::cout << book << "\n";
-    std::cout << oreToMakeFuel (book) << "\n";
-    std::cout << howMuchFuelFromTrillionOre (book) << "\n";
+    Factory factory = compileFactory (book);
+    std::vector<unsigned long long> needs;
+    std::cout << oreToMakeFuel (factory, 1ULL, needs) << "\n";
+    std::cout << maxFuelFromOre (factory, 1'000'000'000'000ULL) << "\n";
     return 0;
 }
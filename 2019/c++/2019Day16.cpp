@@ -8,6 +8,9 @@
 #include <cassert>
 #include <iomanip>
 #include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
 
 #include "utilities.hpp"
 
@@ -274,13 +277,155 @@ std::string justGiveUsPartWeCareAbout (Sequence const& original, unsigned int ph
 }
 
 
+// One phase in O(n log n): with prefix sums, output digit k is a signed sum over blocks of length k + 1, and there
+//   are only n / (k + 1) of those.
+void doPhaseFast (Sequence const& input, Sequence & output, std::vector<int> & prefix) {
+    std::size_t const size = input.size ();
+    prefix.resize (size + 1U);
+    prefix[0] = 0;
+    for (std::size_t index {0U}; index < size; ++index) {
+        prefix[index + 1U] = prefix[index] + input[index];
+    }
+    output.resize (size);
+    for (std::size_t index {0U}; index < size; ++index) {
+        std::size_t const block = index + 1U;
+        int sum {0};
+        // Positive blocks start at block - 1, negative ones at 3 * block - 1, and both repeat every 4 * block.
+        for (std::size_t start {block - 1U}; start < size; start += 4U * block) {
+            sum += prefix[std::min (start + block, size)] - prefix[start];
+            std::size_t const negative = start + 2U * block;
+            if (negative < size) {
+                sum -= prefix[std::min (negative + block, size)] - prefix[negative];
+            }
+        }
+        output[index] = std::abs (sum) % 10;
+    }
+}
+
+Sequence doMultiplePhasesFast (Sequence const& input, unsigned int toDo) {
+    Sequence current = input;
+    Sequence next;
+    std::vector<int> prefix;
+    for (unsigned int count {0U}; count < toDo; ++count) {
+        doPhaseFast (current, next, prefix);
+        std::swap (current, next);
+    }
+    return current;
+}
+
+// The digits from some offset to the end of the input repeated some number of times.
+std::vector<std::uint8_t> getTail (Sequence const& original, unsigned int duplications, std::size_t offset) {
+    std::size_t const total = original.size () * duplications;
+    assert (offset <= total);
+    std::vector<std::uint8_t> tail (total - offset);
+    for (std::size_t index {0U}; index < tail.size (); ++index) {
+        tail[index] = original[(offset + index) % original.size ()];
+    }
+    return tail;
+}
+
+constexpr std::size_t LANES = 32U;
+
+// In the second half of a sequence every pattern is 0s and then 1s, so a phase is just a sum of everything after,
+//   which is one reverse running sum.  Kept in bytes, folded back below 10 without a division.
+// The running sum is a chain within a phase, but the tail can be cut into LANES chunks whose chains are independent:
+//   each chunk only needs the total of the chunks after it, which is one carry per chunk.  The chunks are
+//   interleaved so that one row holds a digit from each, and the carries are added as the next phase reads them.
+void doSuffixPhases (std::vector<std::uint8_t> & tail, unsigned int phases) {
+    std::size_t const rows = (tail.size () + LANES - 1U) / LANES;
+    std::vector<std::uint8_t> interleaved (rows * LANES, 0U);
+    for (std::size_t index {0U}; index < tail.size (); ++index) {
+        interleaved[(index % rows) * LANES + index / rows] = tail[index];
+    }
+    // Below 10, subtracting 10 wraps around to something bigger, so the smaller of the two is the digit.
+    auto fold = [] (std::uint8_t value) { return std::min<std::uint8_t> (value, value - 10U); };
+    std::uint8_t carries[LANES] = {};
+    for (unsigned int phase {0U}; phase < phases; ++phase) {
+        std::uint8_t sums[LANES] = {};
+        for (std::size_t row {rows}; row-- > 0U;) {
+            // Copied through a local row, since a byte pointer into the table could alias the sums.
+            std::uint8_t digits[LANES];
+            std::memcpy (digits, &interleaved[row * LANES], LANES);
+            for (std::size_t lane {0U}; lane < LANES; ++lane) {
+                sums[lane] = fold (sums[lane] + fold (digits[lane] + carries[lane]));
+            }
+            std::memcpy (&interleaved[row * LANES], sums, LANES);
+        }
+        std::uint8_t later {0U};
+        for (std::size_t lane {LANES}; lane-- > 0U;) {
+            carries[lane] = later;
+            later = fold (later + sums[lane]);
+        }
+    }
+    for (std::size_t index {0U}; index < tail.size (); ++index) {
+        tail[index] = (interleaved[(index % rows) * LANES + index / rows] + carries[index / rows]) % 10U;
+    }
+}
+
+// (n choose k) mod p for a small prime p, by Lucas' theorem: the product of the choices of base-p digits.
+unsigned int binomialModPrime (unsigned long n, unsigned long k, unsigned int p) {
+    static constexpr unsigned int SMALL[5][5] = {{1, 0, 0, 0, 0}, {1, 1, 0, 0, 0}, {1, 2, 1, 0, 0}, {1, 3, 3, 1, 0}, {1, 4, 6, 4, 1}};
+    assert (p == 2U || p == 5U);
+    unsigned int result {1U};
+    while (k > 0UL && result != 0U) {
+        result = result * SMALL[n % p][k % p] % p;
+        n /= p;
+        k /= p;
+    }
+    return result;
+}
+
+// (n choose k) mod 10, from mod 2 and mod 5 by the Chinese remainder theorem.
+unsigned int binomialMod10 (unsigned long n, unsigned long k) {
+    return (5U * binomialModPrime (n, k, 2U) + 6U * binomialModPrime (n, k, 5U)) % 10U;
+}
+
+// Jumps straight to the digits after all of the phases: a second-half digit after p phases is the sum over j of
+//   (p - 1 + j choose j) times the digit j places later.
+std::string doSuffixPhasesBinomial (std::vector<std::uint8_t> const& tail, unsigned int phases, unsigned int length) {
+    std::vector<std::uint8_t> coefficients (tail.size ());
+    for (std::size_t offset {0U}; offset < tail.size (); ++offset) {
+        coefficients[offset] = binomialMod10 (phases - 1U + offset, offset);
+    }
+    std::string result = "";
+    for (std::size_t index {0U}; index < length && index < tail.size (); ++index) {
+        unsigned long sum {0UL};
+        for (std::size_t offset {0U}; index + offset < tail.size (); ++offset) {
+            sum += coefficients[offset] * tail[index + offset];
+        }
+        result += ('0' + sum % 10U);
+    }
+    return result;
+}
+
+std::string getMessage (Sequence const& original, unsigned int duplications, unsigned int phases, unsigned int length, bool binomial) {
+    std::size_t const offset = sublist (original, 0U, 7U);
+    std::size_t const total = original.size () * duplications;
+    if (2U * offset < total) {
+        Sequence after = doMultiplePhasesFast (expand (original, duplications), phases);
+        return strlist (after, offset, length);
+    }
+    std::vector<std::uint8_t> tail = getTail (original, duplications, offset);
+    if (binomial) {
+        return doSuffixPhasesBinomial (tail, phases, length);
+    }
+    doSuffixPhases (tail, phases);
+    std::string result = "";
+    for (std::size_t index {0U}; index < length && index < tail.size (); ++index) {
+        result += ('0' + tail[index]);
+    }
+    return result;
+}
+
 constexpr unsigned int PHASES = 100U;
 
-int main () {
+int main (int argc, char* argv[]) {
+    bool binomial = argc > 1 && std::strcmp (argv[1], "--binomial") == 0;
     Sequence input = getInput ();
-    Sequence after100 = doMultiplePhases (input, PHASES);
+    Sequence after100 = doMultiplePhasesFast (input, PHASES);
     std::cout << sublist (after100, 0U, 8U) << "\n";
-    Sequence expanded = expand (input, 10000U);
-    std::cout << justGiveUsPartWeCareAbout (expanded, PHASES, sublist (input, 0U, 7U), 8U) << "\n";
+    if (input.size () >= 7U && sublist (input, 0U, 7U) + 8U <= 10000U * input.size ()) {
+        std::cout << getMessage (input, 10000U, PHASES, 8U, binomial) << "\n";
+    }
     return 0;
 }
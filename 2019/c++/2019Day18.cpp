@@ -14,6 +14,9 @@
 #include <deque>
 #include <array>
 #include <cctype>
+#include <cstdint>
+#include <queue>
+#include <functional>
 
 #include "utilities.hpp"
 
@@ -287,12 +290,185 @@ Board divideMap (Board const& original) {
     return result;
 }
 
+// A walk from a robot's start or a key to another key that passes no other keys along the way.
+struct KeyRoute {
+    std::size_t to;
+    unsigned int distance;
+    std::uint32_t keysNeeded;
+};
+
+// Nodes 0 through robots - 1 are the robots' starting points, and node robots + k is key 'a' + k.
+struct KeyGraph {
+    std::size_t robots;
+    std::uint32_t allKeys;
+    std::vector<std::vector<KeyRoute>> routes;
+};
+
+inline std::uint32_t keyBit (char key) { return 1U << (key - 'a'); }
+
+KeyGraph buildKeyGraph (Board const& board) {
+    int rows = board.picture.size ();
+    int cols = rows == 0 ? 0 : board.picture[0].size ();
+    std::vector<char> cells (rows * cols, WALL);
+    for (int row {0}; row < rows; ++row) {
+        for (int col {0}; col < (int)board.picture[row].size (); ++col) {
+            cells[row * cols + col] = board.picture[row][col];
+        }
+    }
+    for (std::pair<const char, Coordinate> const& key : board.keyLocations) { cells[key.second.row * cols + key.second.col] = key.first; }
+    for (std::pair<const char, Coordinate> const& door : board.doorLocations) { cells[door.second.row * cols + door.second.col] = door.first; }
+
+    KeyGraph graph {board.initialPlayerLocs.size (), 0U, std::vector<std::vector<KeyRoute>> (board.initialPlayerLocs.size () + MAX_KEYS)};
+    assert (graph.robots <= 6U);
+    std::vector<std::pair<std::size_t, Coordinate>> sources;
+    for (std::size_t robot {0U}; robot < graph.robots; ++robot) { sources.push_back ({robot, board.initialPlayerLocs[robot]}); }
+    for (std::pair<const char, Coordinate> const& key : board.keyLocations) {
+        sources.push_back ({graph.robots + (key.first - 'a'), key.second});
+        graph.allKeys |= keyBit (key.first);
+    }
+
+    // One breadth-first search per source, never walking through a key: a longer walk through a key is just two routes.
+    std::vector<int> distances (cells.size ());
+    std::vector<std::uint32_t> needed (cells.size ());
+    std::deque<int> queue;
+    for (std::pair<std::size_t, Coordinate> const& source : sources) {
+        std::fill (distances.begin (), distances.end (), -1);
+        int start = source.second.row * cols + source.second.col;
+        distances[start] = 0;
+        needed[start] = 0U;
+        queue.push_back (start);
+        while (!queue.empty ()) {
+            int cell = queue.front ();
+            queue.pop_front ();
+            char symbol = cells[cell];
+            if (isKey (symbol) && cell != start) {
+                graph.routes[source.first].push_back ({graph.robots + (symbol - 'a'), (unsigned int)distances[cell], needed[cell]});
+                continue;
+            }
+            for (int next : {cell - cols, cell + cols, cell - 1, cell + 1}) {
+                if (next < 0 || next >= (int)cells.size () || cells[next] == WALL || distances[next] >= 0) { continue; }
+                distances[next] = distances[cell] + 1;
+                needed[next] = needed[cell] | (isDoor (cells[next]) ? keyBit (doorToKey (cells[next])) : 0U);
+                queue.push_back (next);
+            }
+        }
+    }
+    return graph;
+}
+
+// An open-addressing hash table from search states to distances, with no allocation per entry.
+class FlatDistanceMap {
+public:
+    FlatDistanceMap () : m_keys (1024U, EMPTY), m_values (1024U), m_size {0U} {}
+
+    // Returns true if the state was new or the distance is an improvement.
+    bool improve (std::uint64_t key, unsigned int distance) {
+        if (2U * (m_size + 1U) > m_keys.size ()) { grow (); }
+        std::size_t slot = findSlot (key);
+        if (m_keys[slot] == EMPTY) {
+            m_keys[slot] = key;
+            m_values[slot] = distance;
+            ++m_size;
+            return true;
+        }
+        if (distance < m_values[slot]) {
+            m_values[slot] = distance;
+            return true;
+        }
+        return false;
+    }
+
+    unsigned int get (std::uint64_t key) const {
+        std::size_t slot = findSlot (key);
+        return m_keys[slot] == EMPTY ? UINT_MAX : m_values[slot];
+    }
+
+    std::size_t size () const { return m_size; }
+
+private:
+    static constexpr std::uint64_t EMPTY = ~0ULL;
+
+    std::size_t findSlot (std::uint64_t key) const {
+        std::size_t mask = m_keys.size () - 1U;
+        std::size_t slot = (key * 0x9E3779B97F4A7C15ULL >> 20) & mask;
+        while (m_keys[slot] != EMPTY && m_keys[slot] != key) { slot = (slot + 1U) & mask; }
+        return slot;
+    }
+
+    void grow () {
+        std::vector<std::uint64_t> oldKeys (2U * m_keys.size (), EMPTY);
+        std::vector<unsigned int> oldValues (2U * m_keys.size ());
+        std::swap (oldKeys, m_keys);
+        std::swap (oldValues, m_values);
+        for (std::size_t index {0U}; index < oldKeys.size (); ++index) {
+            if (oldKeys[index] != EMPTY) {
+                std::size_t slot = findSlot (oldKeys[index]);
+                m_keys[slot] = oldKeys[index];
+                m_values[slot] = oldValues[index];
+            }
+        }
+    }
+
+    std::vector<std::uint64_t> m_keys;
+    std::vector<unsigned int> m_values;
+    std::size_t m_size;
+};
+
+// Dijkstra's algorithm over (where each robot is, which keys have been collected), packed as the key mask in the
+//   high 32 bits and 5 bits per robot position in the low ones.
+unsigned int findAllKeys (KeyGraph const& graph) {
+    constexpr unsigned int POSITION_BITS = 5U;
+    constexpr std::uint64_t POSITION_MASK = (1U << POSITION_BITS) - 1U;
+    using Entry = std::pair<unsigned int, std::uint64_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> frontier;
+    FlatDistanceMap distances;
+    std::uint64_t initial {0U};
+    for (std::size_t robot {0U}; robot < graph.robots; ++robot) { initial |= (std::uint64_t)robot << (POSITION_BITS * robot); }
+    distances.improve (initial, 0U);
+    frontier.push ({0U, initial});
+    while (!frontier.empty ()) {
+        Entry current = frontier.top ();
+        frontier.pop ();
+        if (current.first > distances.get (current.second)) { continue; }
+        std::uint32_t keys = current.second >> 32;
+        if (keys == graph.allKeys) { return current.first; }
+        for (std::size_t robot {0U}; robot < graph.robots; ++robot) {
+            unsigned int shift = POSITION_BITS * robot;
+            std::size_t at = (current.second >> shift) & POSITION_MASK;
+            for (KeyRoute const& route : graph.routes[at]) {
+                if ((route.keysNeeded & ~keys) != 0U) { continue; }
+                std::uint32_t collected = keys | (1U << (route.to - graph.robots));
+                std::uint64_t next = ((std::uint64_t)collected << 32) | (current.second & 0xFFFFFFFFULL & ~(POSITION_MASK << shift)) | ((std::uint64_t)route.to << shift);
+                unsigned int distance = current.first + route.distance;
+                if (distances.improve (next, distance)) { frontier.push ({distance, next}); }
+            }
+        }
+    }
+    return UINT_MAX;
+}
+
+bool canDivide (Board const& board) {
+    if (board.initialPlayerLocs.size () != 1U) { return false; }
+    Coordinate center = board.initialPlayerLocs[0];
+    for (int row {center.row - 1}; row <= center.row + 1; ++row) {
+        for (int col {center.col - 1}; col <= center.col + 1; ++col) {
+            Coordinate where {row, col};
+            bool occupied = false;
+            for (std::pair<const char, Coordinate> const& key : board.keyLocations) { occupied = occupied || key.second == where; }
+            for (std::pair<const char, Coordinate> const& door : board.doorLocations) { occupied = occupied || door.second == where; }
+            if (occupied || board.picture[row][col] != PASSAGE) { return false; }
+        }
+    }
+    return true;
+}
+
 int main () {
     assert (isDoor ('B'));
     Board original = getInput ();
-    //std::cout << initial << "\n";
-    //std::cout << findAllKeysBF (initial) << "\n";
-    Board revised = divideMap (original);
-    std::cout << findAllKeysBF (revised) << "\n";
+    std::cout << findAllKeys (buildKeyGraph (original)) << "\n";
+    if (canDivide (original)) {
+        Board revised = divideMap (original);
+        std::cout << findAllKeys (buildKeyGraph (revised)) << "\n";
+    }
     return 0;
 }
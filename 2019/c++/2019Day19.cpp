@@ -7,82 +7,208 @@
 #include <fstream>
 #include <string>
 #include <chrono>
-#include <thread>
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 
 #include "utilities.hpp"
 #include "intcode.hpp"
 
-unsigned int countAffectedPoints (NumbersList const& prog, unsigned int maxRow, unsigned int maxCol) {
-    unsigned int result {0U};
-    unsigned int lowCol {0U};
-    ICComputer comp;
-    for (unsigned int row {0U}; row <= maxRow; ++row) {
-        bool found1 = false;
-        for (unsigned int col {lowCol}; col <= maxCol; ++col) {
-            comp.loadProgram (prog, {col, row});
-            comp.executeAllInstructions ();
-            assert (comp.getOutputs ().size () == 1);
-            Number output = comp.getOutputs ().back ();
-            if (output == 1) {
-                ++result;
-                if (!found1) { lowCol = col; }
-                found1 = true;
+// Answers whether cells are in the beam, remembering every answer.
+// Each machine in the pool is reused for many probes, so its memory and input / output vectors keep their capacity.
+class BeamProber {
+public:
+    BeamProber (NumbersList const& prog)
+    : m_prog {prog}, m_machines (workerCount ()), m_cache {}, m_probes {0U} {
+    }
+
+    bool probe (Number col, Number row) {
+        auto found = m_cache.find (pack (col, row));
+        if (found != m_cache.end ()) { return found->second; }
+        bool result = run (m_machines[0], col, row);
+        ++m_probes;
+        m_cache[pack (col, row)] = result;
+        return result;
+    }
+
+    // Fills the cache for a batch of cells, spreading the ones it has not seen across the machines.
+    void probeMany (std::vector<std::pair<Number, Number>> const& cells) {
+        std::vector<std::pair<Number, Number>> unknown;
+        for (auto const& cell : cells) {
+            if (cell.first >= 0 && m_cache.find (pack (cell.first, cell.second)) == m_cache.end ()) {
+                unknown.push_back (cell);
             }
-            else if (found1) {
-                break;
+        }
+        std::sort (unknown.begin (), unknown.end ());
+        unknown.erase (std::unique (unknown.begin (), unknown.end ()), unknown.end ());
+        std::vector<char> results (unknown.size ());
+        unsigned int threads = unknown.size () < PARALLEL_BATCH ? 1U : m_machines.size ();
+        forEachIndex (unknown.size (), [&] (std::size_t index, unsigned int thread) {
+            results[index] = run (m_machines[thread], unknown[index].first, unknown[index].second);
+        }, threads);
+        for (std::size_t index = 0; index < unknown.size (); ++index) {
+            m_cache[pack (unknown[index].first, unknown[index].second)] = results[index];
+        }
+        m_probes += unknown.size ();
+    }
+
+    unsigned long long probeCount () const { return m_probes; }
+
+private:
+    static const std::size_t PARALLEL_BATCH = 256;
+
+    static std::uint64_t pack (Number col, Number row) {
+        return ((std::uint64_t)(std::uint32_t)row << 32) | (std::uint32_t)col;
+    }
+
+    bool run (ICComputer& comp, Number col, Number row) const {
+        comp.loadProgram (m_prog);
+        comp.addInput (col);
+        comp.addInput (row);
+        comp.executeAllInstructions ();
+        return comp.getLastOutput () == 1;
+    }
+
+    NumbersList m_prog;
+    std::vector<ICComputer> m_machines;
+    std::unordered_map<std::uint64_t, bool> m_cache;
+    unsigned long long m_probes;
+};
+
+// The first and last column of the beam in each row, with first > last for rows the beam misses.
+struct BeamEdges {
+    std::vector<Number> left;
+    std::vector<Number> right;
+
+    bool isEmpty (Number row) const { return left[row] > right[row]; }
+};
+
+// Follows the two edges of the beam down the rows.
+// The beam is a cone from the origin, so once it is wider than a cell both edges only ever move right,
+//   and each row is found from the one above it with a few probes.
+// Far from the origin the edges are nearly straight lines, so a block of rows at a time is guessed from the slope
+//   and the cells around the guesses are probed as one batch; the walk that follows only probes where a guess was wrong.
+class BeamTracer {
+public:
+    BeamTracer (BeamProber& prober) : m_prober {prober}, m_edges {} {
+    }
+
+    BeamEdges const& edges () const { return m_edges; }
+
+    // Makes sure the edges are known for every row up to and including lastRow.
+    void traceThrough (Number lastRow) {
+        while ((Number)m_edges.left.size () <= lastRow) {
+            Number row = m_edges.left.size ();
+            if (row >= SPECULATE_FROM && !m_edges.isEmpty (row - 1)) {
+                guessBlock (row, std::min<Number> (row + BLOCK_SIZE, lastRow + 1));
             }
+            traceRow (row);
         }
     }
+
+private:
+    // No beam in this puzzle is anywhere near this steep, so a row with nothing in this many columns per row is empty.
+    static const Number MAX_SLOPE = 8;
+    static const Number SPECULATE_FROM = 100;
+    static const Number BLOCK_SIZE = 512;
+
+    void traceRow (Number row) {
+        Number limit = MAX_SLOPE * (row + 1);
+        Number left {0}, right {-1};
+        bool afterBeam = row > 0 && !m_edges.isEmpty (row - 1);
+        Number start = afterBeam ? m_edges.left[row - 1] : 0;
+        Number guess = row < (Number)m_guessLeft.size () ? std::max (m_guessLeft[row], start) : start;
+        if (m_prober.probe (guess, row)) {
+            left = guess;
+            while (left > start && m_prober.probe (left - 1, row)) { --left; }
+        }
+        else {
+            left = start;
+            while (left <= limit && !m_prober.probe (left, row)) { ++left; }
+        }
+        if (left <= limit) {
+            right = std::max (left, afterBeam ? m_edges.right[row - 1] : left);
+            if (row < (Number)m_guessRight.size ()) { right = std::max (right, m_guessRight[row]); }
+            if (m_prober.probe (right, row)) {
+                while (m_prober.probe (right + 1, row)) { ++right; }
+            }
+            else {
+                while (!m_prober.probe (right, row)) { --right; }
+            }
+        }
+        else {
+            left = 0;
+        }
+        m_edges.left.push_back (left);
+        m_edges.right.push_back (right);
+    }
+
+    // Guesses both edges for rows [first, last) by extending the lines from the origin through the row before first,
+    //   and probes the cells on either side of each guess all at once.
+    void guessBlock (Number first, Number last) {
+        Number known = first - 1;
+        m_guessLeft.resize (last);
+        m_guessRight.resize (last);
+        std::vector<std::pair<Number, Number>> cells;
+        for (Number row {first}; row < last; ++row) {
+            m_guessLeft[row] = (m_edges.left[known] * row + known / 2) / known;
+            m_guessRight[row] = (m_edges.right[known] * row + known / 2) / known;
+            cells.push_back ({m_guessLeft[row] - 1, row});
+            cells.push_back ({m_guessLeft[row], row});
+            cells.push_back ({m_guessRight[row], row});
+            cells.push_back ({m_guessRight[row] + 1, row});
+        }
+        m_prober.probeMany (cells);
+    }
+
+    BeamProber& m_prober;
+    BeamEdges m_edges;
+    std::vector<Number> m_guessLeft;
+    std::vector<Number> m_guessRight;
+};
+
+unsigned int countAffectedPoints (BeamTracer& tracer, Number maxRow, Number maxCol) {
+    tracer.traceThrough (maxRow);
+    BeamEdges const& edges = tracer.edges ();
+    unsigned int result {0U};
+    for (Number row {0}; row <= maxRow; ++row) {
+        Number left = edges.left[row];
+        Number right = std::min (edges.right[row], maxCol);
+        if (right >= left) { result += right - left + 1; }
+    }
     return result;
 }
 
-long long find100SZquare (NumbersList const& prog) {
-    std::vector<std::pair<Number, Number>> rows;
-    ICComputer comp;
-    Number currentRow {0U};
-    Number startCol {0U};
+// Tracks the lower-left corner of the square down the left edge of the beam.
+// With that corner at the left edge of the bottom row, the square fits as soon as the top row reaches its right side.
+long long findSquare (BeamTracer& tracer, Number size) {
+    Number row = size - 1;
     while (true) {
-        bool found1 = false;
-        Number currentCol {startCol};
-        Number first1 {0};
-        while (true) {
-            comp.loadProgram (prog, {currentCol, currentRow});
-            comp.executeAllInstructions ();
-            Number output = comp.getOutputs ().back ();
-            if (output == 1) {
-                if (!found1) {
-                    first1 = currentCol;
-                    found1 = true;
-                }
-            }
-            else if (found1) {
-                rows.push_back ({first1, currentCol - 1});
-                startCol = first1;
-                Coordinate upperLeft {(int)currentRow - 99, (int)first1};
-                Coordinate lowerRight {(int)currentRow, (int)first1 + 99};
-                if (currentRow >= 99 && rows[currentRow - 99].second >= first1 + 99) {
-                    return upperLeft.col * 10000LL + upperLeft.row;
-                }
-                break;
-            }
-            else if (currentCol - startCol > 1000) { 
-                // give up, assume this row doesn't have any 1s at all
-                rows.push_back ({-1, -1});
-                break;
-            }
-            ++currentCol;
+        tracer.traceThrough (row);
+        BeamEdges const& edges = tracer.edges ();
+        Number top = row - size + 1;
+        Number left = edges.left[row];
+        if (!edges.isEmpty (row) && !edges.isEmpty (top) && edges.left[top] <= left && edges.right[top] >= left + size - 1) {
+            return left * 10000LL + top;
         }
-        ++currentRow;
+        ++row;
     }
 }
 
-int main () {
+int main (int argc, char* argv[]) {
     std::ifstream fin ("../inputs/Day19.my.input");
     NumbersList prog = parseNumbersList (read<std::string> (fin));
     fin.close ();
-    std::cout << countAffectedPoints (prog, 49, 49) << "\n";
-    std::cout << find100SZquare (prog) << "\n";
+    BeamProber prober {prog};
+    BeamTracer tracer {prober};
+    std::cout << countAffectedPoints (tracer, 49, 49) << "\n";
+    std::cout << findSquare (tracer, 100) << "\n";
+    if (argc > 1) {
+        Number size = std::atoll (argv[1]);
+        std::cout << findSquare (tracer, size) << "\n";
+    }
     return 0;
 }
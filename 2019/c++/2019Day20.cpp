@@ -14,6 +14,12 @@
 #include <deque>
 #include <array>
 #include <cctype>
+#include <sstream>
+#include <cstring>
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
 
 #include "utilities.hpp"
 
@@ -40,10 +46,10 @@ Coordinate getNeighboringLetter (Board const& board, Coordinate const& where) {
     return NOWHERE;
 }
 
-Board getInput () {
+Board getInput (std::istream& in = std::cin) {
     Board board;
     std::string line;
-    while (std::getline (std::cin, line)) {
+    while (std::getline (in, line)) {
         board.picture.push_back ({});
         for (char c : line) {
             board.picture.back ().push_back (c);
@@ -82,114 +88,197 @@ Board getInput () {
     return board;
 }
 
-Coordinate findClosest (std::unordered_map<Coordinate, unsigned int> const& map) {
-    Coordinate chosen = map.begin ()->first;
-    for (std::pair<Coordinate const, unsigned int> const& pair : map) {
-        if (pair.second < map.at (chosen)) {
-            chosen = pair.first;
-        }
-    }
-    return chosen;
+inline bool isInside (Board const& board, Coordinate const& where) {
+    return where.row > 2 && where.row < (int)board.picture.size () - 3 && where.col > 2 && where.col < (int)board.picture[0].size () - 3;
 }
 
-unsigned int getShortestPathLength (Board const& board) {
-    std::unordered_map<Coordinate, unsigned int> finished;
-    std::unordered_map<Coordinate, unsigned int> unfinished;
-    unfinished.insert ({board.start, 0U});
-    while (finished.count (board.goal) == 0) {
-        assert (!unfinished.empty ());
-        Coordinate currentLoc = findClosest (unfinished);
-        unsigned int currentDist = unfinished[currentLoc];
-        unfinished.erase (currentLoc);
-        std::vector<Coordinate> neighbors = getNeighbors (currentLoc);
-        if (board.portals.count (currentLoc) == 1) {
-            neighbors.push_back (board.portals.at (currentLoc));
+// The maze boiled down to the cells next to portal letters (including the start and goal),
+//   with the walking distance between every pair of them that can reach each other without going through a portal.
+struct PortalGraph {
+    struct Route {
+        std::size_t to;
+        unsigned int length;
+    };
+    std::vector<Coordinate> where;
+    // The endpoint at the other end of each portal, or NO_PARTNER for the start and goal.
+    std::vector<std::size_t> partner;
+    // Whether each endpoint is on the inside of the donut, so that using its portal goes one level deeper.
+    std::vector<bool> inner;
+    std::vector<std::vector<Route>> routes;
+    std::size_t start;
+    std::size_t goal;
+};
+
+constexpr std::size_t NO_PARTNER = SIZE_MAX;
+
+PortalGraph compilePortalGraph (Board const& board) {
+    PortalGraph graph;
+    std::unordered_map<Coordinate, std::size_t> index;
+    auto addEndpoint = [&] (Coordinate const& where) {
+        if (index.count (where) == 0) {
+            index[where] = graph.where.size ();
+            graph.where.push_back (where);
+            graph.inner.push_back (isInside (board, where));
         }
-        for (Coordinate neighbor : neighbors) {
-            if (finished.count (neighbor) == 0) {
-                if (board.picture[neighbor.row][neighbor.col] == PASSAGE) {
-                    if (unfinished.count (neighbor) == 0 || unfinished[neighbor] > currentDist + 1) {
-                        unfinished[neighbor] = currentDist + 1;
-                    }
+    };
+    addEndpoint (board.start);
+    addEndpoint (board.goal);
+    for (std::pair<Coordinate const, Coordinate> const& portal : board.portals) {
+        addEndpoint (portal.first);
+    }
+    graph.start = index[board.start];
+    graph.goal = index[board.goal];
+    graph.partner.assign (graph.where.size (), NO_PARTNER);
+    for (std::pair<Coordinate const, Coordinate> const& portal : board.portals) {
+        graph.partner[index[portal.first]] = index[portal.second];
+    }
+
+    // One breadth-first search of the cells per endpoint, sharing a distance grid that is stamped with the source.
+    int width {0};
+    for (std::vector<char> const& row : board.picture) { width = std::max (width, (int)row.size ()); }
+    int height = board.picture.size ();
+    std::vector<unsigned int> distance (width * height);
+    std::vector<std::size_t> seenBy (width * height, NO_PARTNER);
+    auto isPassage = [&] (Coordinate const& c) {
+        return c.row >= 0 && c.row < height && c.col >= 0 && c.col < (int)board.picture[c.row].size () && board.picture[c.row][c.col] == PASSAGE;
+    };
+    graph.routes.resize (graph.where.size ());
+    for (std::size_t source {0U}; source < graph.where.size (); ++source) {
+        std::deque<Coordinate> queue {graph.where[source]};
+        seenBy[graph.where[source].row * width + graph.where[source].col] = source;
+        distance[graph.where[source].row * width + graph.where[source].col] = 0U;
+        while (!queue.empty ()) {
+            Coordinate current = queue.front ();
+            queue.pop_front ();
+            unsigned int currentDist = distance[current.row * width + current.col];
+            auto found = index.find (current);
+            if (found != index.end () && found->second != source) {
+                graph.routes[source].push_back ({found->second, currentDist});
+            }
+            for (Coordinate neighbor : getNeighbors (current)) {
+                if (isPassage (neighbor) && seenBy[neighbor.row * width + neighbor.col] != source) {
+                    seenBy[neighbor.row * width + neighbor.col] = source;
+                    distance[neighbor.row * width + neighbor.col] = currentDist + 1;
+                    queue.push_back (neighbor);
                 }
             }
         }
-        finished[currentLoc] = currentDist;
     }
-    return finished[board.goal];
+    return graph;
 }
 
-struct RecCoord {
-    Coordinate coord;
-    int depth;
-};
-
-bool operator== (RecCoord const& x, RecCoord const& y) {
-    return x.depth == y.depth && x.coord == y.coord;
-}
-
-template<>
-struct std::hash<RecCoord> {
-    std::size_t operator()(RecCoord const& rc) const {
-        static std::hash<Coordinate> coordHasher;
-        return coordHasher (rc.coord) * 97 + rc.depth;
+// Dijkstra's algorithm over (endpoint, level) pairs, with a binary heap.
+// Levels only matter when recursive; then inner portals go down a level, outer portals go up one, and
+//   outer portals on the top level are walls.
+// Getting back to the top from level L takes at least L climbs, each a walk to an outer endpoint and a step through it,
+//   except that the first climb is just the step when already standing on an outer endpoint.
+// So once the goal has been reached any state that could not beat that even with the shortest climbs is dropped.
+// No search goes deeper than maxDepth, which keeps a maze with no way out from running forever; it gives UINT_MAX instead.
+unsigned int getShortestPathLength (PortalGraph const& graph, bool recursive, int maxDepth) {
+    unsigned int minClimb {UINT_MAX};
+    for (std::size_t from {0U}; from < graph.routes.size (); ++from) {
+        for (PortalGraph::Route const& route : graph.routes[from]) {
+            if (graph.partner[route.to] != NO_PARTNER && !graph.inner[route.to]) {
+                minClimb = std::min (minClimb, route.length + 1);
+            }
+        }
     }
-};
-
-std::vector<RecCoord> getNeighbors (RecCoord c) {
-    return { {{c.coord.row - 1, c.coord.col}, c.depth}, {{c.coord.row + 1, c.coord.col}, c.depth}, {{c.coord.row, c.coord.col - 1}, c.depth}, {{c.coord.row, c.coord.col + 1}, c.depth} };
-}
+    std::size_t nodes = graph.where.size ();
+    int levels = recursive ? maxDepth + 1 : 1;
+    std::vector<unsigned int> best (nodes, UINT_MAX);
+    unsigned int bestGoal {UINT_MAX};
+    auto lowerBound = [&] (unsigned int dist, std::size_t node, int level) {
+        if (minClimb == UINT_MAX || level == 0) { return (unsigned long long)dist; }
+        if (graph.partner[node] != NO_PARTNER && !graph.inner[node]) {
+            return dist + 1ULL + (unsigned long long)(level - 1) * minClimb;
+        }
+        return dist + (unsigned long long)level * minClimb;
+    };
 
-RecCoord findClosest (std::unordered_map<RecCoord, unsigned int> const& map) {
-    RecCoord chosen = map.begin ()->first;
-    for (std::pair<RecCoord const, unsigned int> const& pair : map) {
-        if (pair.second < map.at (chosen)) {
-            chosen = pair.first;
+    using State = std::pair<unsigned int, std::size_t>;
+    std::priority_queue<State, std::vector<State>, std::greater<State>> frontier;
+    auto push = [&] (unsigned int dist, std::size_t node, int level) {
+        std::size_t state = level * nodes + node;
+        if (level < 0 || level >= levels || lowerBound (dist, node, level) >= bestGoal) { return; }
+        if (state >= best.size ()) { best.resize ((level + 1) * nodes, UINT_MAX); }
+        if (dist < best[state]) {
+            best[state] = dist;
+            frontier.push ({dist, state});
+        }
+    };
+    push (0U, graph.start, 0);
+    while (!frontier.empty ()) {
+        auto [dist, state] = frontier.top ();
+        frontier.pop ();
+        if (dist > best[state]) { continue; }
+        std::size_t node = state % nodes;
+        int level = state / nodes;
+        if (node == graph.goal && level == 0) { return dist; }
+        if (lowerBound (dist, node, level) >= bestGoal) { continue; }
+        for (PortalGraph::Route const& route : graph.routes[node]) {
+            if (route.to == graph.goal && level == 0) { bestGoal = std::min (bestGoal, dist + route.length); }
+            push (dist + route.length, route.to, level);
+        }
+        std::size_t partner = graph.partner[node];
+        if (partner != NO_PARTNER) {
+            int nextLevel = !recursive ? 0 : graph.inner[node] ? level + 1 : level - 1;
+            push (dist + 1, partner, nextLevel);
         }
     }
-    return chosen;
+    return bestGoal;
 }
 
-inline bool isInside (Board const& board, Coordinate const& where) {
-    return where.row > 2 && where.row < (int)board.picture.size () - 3 && where.col > 2 && where.col < (int)board.picture[0].size () - 3;
-}
-
-unsigned int getRecursiveShortestPathLength (Board const& board) {
-    std::unordered_map<RecCoord, unsigned int> finished;
-    std::unordered_map<RecCoord, unsigned int> unfinished;
-    unfinished.insert ({{board.start, 0}, 0U});
-    RecCoord goal {board.goal, 0};
-    while (finished.count (goal) == 0) {
-        assert (!unfinished.empty ());
-        RecCoord currentLoc = findClosest (unfinished);
-        unsigned int currentDist = unfinished[currentLoc];
-        unfinished.erase (currentLoc);
-        std::vector<RecCoord> neighbors = getNeighbors (currentLoc);
-        if (board.portals.count (currentLoc.coord) == 1) {
-            if (isInside (board, currentLoc.coord)) {
-                neighbors.push_back ({board.portals.at (currentLoc.coord), currentLoc.depth + 1});
-            }
-            else if (currentLoc.depth != 0) {
-                neighbors.push_back ({board.portals.at (currentLoc.coord), currentLoc.depth - 1});                
-            }
-        }
-        for (RecCoord neighbor : neighbors) {
-            if (finished.count (neighbor) == 0) {
-                if (board.picture[neighbor.coord.row][neighbor.coord.col] == PASSAGE) {
-                    if (unfinished.count (neighbor) == 0 || unfinished[neighbor] > currentDist + 1) {
-                        unfinished[neighbor] = currentDist + 1;
-                    }
-                }
-            }
-        }
-        finished[currentLoc] = currentDist;
+// Mazes that have caught mistakes before, with their shortest path lengths.
+void runRegressionTests () {
+    // The quickest way out goes down through BC and back up through DE, and the climb back up starts
+    //   on an outer endpoint, so it must not be charged for a walk to one.
+    std::string const climbFromOuterEndpoint = R"(
+          A              
+          A              
+  ####.....############  
+  ####.###.############  
+  ####.###.############  
+  ####.###.###########.BC
+  ####.###.###########.  
+  ####.   B       ####.  
+  ####.   C       ####.  
+  ####.           ####.  
+  ####.           ####.  
+  ####.    D      ####.  
+  ####.    E      ####.  
+  ####.####.##########.  
+  ####.####.##########.  
+  ####.####.##########.DE
+  ####.####.###########  
+  ####......###########  
+           Z             
+           Z             
+)";
+    std::istringstream in {climbFromOuterEndpoint.substr (1)};
+    PortalGraph graph = compilePortalGraph (getInput (in));
+    if (getShortestPathLength (graph, false, 0) != 20U) {
+        std::cout << "Climb from outer endpoint, flat version, failed!\n";
+    }
+    if (getShortestPathLength (graph, true, graph.where.size ()) != 20U) {
+        std::cout << "Climb from outer endpoint, recursive version, failed!\n";
     }
-    return finished[goal];
+    if (getShortestPathLength (graph, true, 1) != 20U) {
+        std::cout << "Climb from outer endpoint, recursive version with depth 1, failed!\n";
+    }
+    std::cout << "Finished running tests.\n";
 }
 
-int main () {
+int main (int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp (argv[1], "--test") == 0) {
+        runRegressionTests ();
+        return 0;
+    }
     Board board = getInput ();
-    std::cout << "Shortest path start to goal: " << getShortestPathLength (board) << "\n";
-    std::cout << "Recursive version: " << getRecursiveShortestPathLength (board) << "\n";
+    PortalGraph graph = compilePortalGraph (board);
+    // Every trip down has to come back up, and needing more round trips than there are portals is unheard of.
+    int maxDepth = argc > 1 ? std::atoi (argv[1]) : (int)graph.where.size ();
+    auto show = [] (unsigned int length) { return length == UINT_MAX ? std::string ("none") : std::to_string (length); };
+    std::cout << "Shortest path start to goal: " << show (getShortestPathLength (graph, false, 0)) << "\n";
+    std::cout << "Recursive version: " << show (getShortestPathLength (graph, true, maxDepth)) << "\n";
     return 0;
 }
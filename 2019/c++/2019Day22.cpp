@@ -1,7 +1,6 @@
 /// \file 2019Day22.cpp
 /// \author Chad Hogg
 /// \brief My solution to https://adventofcode.com/2019/day/22.
-/// \note I am leaving this in a broken state because I just can't spend any more time on it.
 
 #include <iostream>
 #include <cstdio>
@@ -12,6 +11,8 @@
 #include <deque>
 #include <stack>
 #include <unordered_map>
+#include <cstring>
+#include <algorithm>
 
 #include "utilities.hpp"
 
@@ -393,15 +394,135 @@ std::vector<Action> simplify (std::vector<Action> const& commands, unsigned long
     }
 }
 
-int main () {
+// Every shuffle action, and so every sequence of them, moves the card at position x to position (a * x + b) mod n.
+struct AffineShuffle {
+    unsigned long long a;
+    unsigned long long b;
+    unsigned long long n;
+
+    unsigned long long apply (unsigned long long position) const;
+};
+
+inline unsigned long long mulMod (unsigned long long x, unsigned long long y, unsigned long long n) {
+    return (unsigned __int128)x * y % n;
+}
+
+inline unsigned long long addMod (unsigned long long x, unsigned long long y, unsigned long long n) {
+    return ((unsigned __int128)x + y) % n;
+}
+
+inline unsigned long long toResidue (long long x, unsigned long long n) {
+    long long r = x % (long long)n;
+    return r < 0 ? r + n : r;
+}
+
+unsigned long long AffineShuffle::apply (unsigned long long position) const {
+    return addMod (mulMod (a, position, n), b, n);
+}
+
+// The shuffle that does first and then second.
+AffineShuffle compose (AffineShuffle const& first, AffineShuffle const& second) {
+    assert (first.n == second.n);
+    return {mulMod (second.a, first.a, first.n), addMod (mulMod (second.a, first.b, first.n), second.b, first.n), first.n};
+}
+
+AffineShuffle compile (std::vector<Action> const& commands, unsigned long long numCards) {
+    AffineShuffle result {1ULL % numCards, 0ULL, numCards};
+    for (Action const& action : commands) {
+        switch (action.type) {
+            case STACK: result = compose (result, {numCards - 1ULL, numCards - 1ULL, numCards}); break;
+            case CUT: result = compose (result, {1ULL, toResidue (-action.param, numCards), numCards}); break;
+            case DEAL: result = compose (result, {toResidue (action.param, numCards), 0ULL, numCards}); break;
+            default: throw std::runtime_error ("Unknown action type.");
+        }
+    }
+    return result;
+}
+
+// The shuffle repeated some number of times, by squaring.
+AffineShuffle power (AffineShuffle const& shuffle, unsigned long long times) {
+    AffineShuffle result {1ULL % shuffle.n, 0ULL, shuffle.n};
+    AffineShuffle square = shuffle;
+    while (times > 0ULL) {
+        if (times & 1ULL) { result = compose (result, square); }
+        times >>= 1;
+        if (times > 0ULL) { square = compose (square, square); }
+    }
+    return result;
+}
+
+// The multiplicative inverse of x mod n, by the extended Euclidean algorithm (so n need not be prime).
+unsigned long long inverseMod (unsigned long long x, unsigned long long n) {
+    __int128 oldR = x, r = n, oldS = 1, s = 0;
+    while (r != 0) {
+        __int128 quotient = oldR / r;
+        __int128 temp = oldR - quotient * r; oldR = r; r = temp;
+        temp = oldS - quotient * s; oldS = s; s = temp;
+    }
+    if (oldR != 1) { throw std::runtime_error ("Shuffle is not reversible: " + std::to_string (x) + " has no inverse."); }
+    return (unsigned long long)((oldS % (__int128)n + n) % n);
+}
+
+// The shuffle that undoes this one: maps each final position to where that card started.
+AffineShuffle inverse (AffineShuffle const& shuffle) {
+    unsigned long long aInverse = inverseMod (shuffle.a, shuffle.n);
+    return {aInverse, mulMod (aInverse, (shuffle.n - shuffle.b) % shuffle.n, shuffle.n), shuffle.n};
+}
+
+unsigned long long positionOfCard (std::vector<Action> const& commands, unsigned long long numCards, unsigned long long repetitions, unsigned long long card) {
+    return power (compile (commands, numCards), repetitions).apply (card);
+}
+
+unsigned long long cardAtPosition (std::vector<Action> const& commands, unsigned long long numCards, unsigned long long repetitions, unsigned long long position) {
+    return inverse (power (compile (commands, numCards), repetitions)).apply (position);
+}
+
+// A straightforward simulator with no affine algebra in it, for checking.
+std::vector<unsigned long long> simulate (std::vector<Action> const& commands, unsigned long long numCards, unsigned long long repetitions) {
+    std::vector<unsigned long long> cards (numCards);
+    std::iota (cards.begin (), cards.end (), 0ULL);
+    std::vector<unsigned long long> next (numCards);
+    for (unsigned long long r {0U}; r < repetitions; ++r) {
+        for (Action const& action : commands) {
+            switch (action.type) {
+                case STACK: std::reverse (cards.begin (), cards.end ()); break;
+                case CUT: std::rotate (cards.begin (), cards.begin () + toResidue (action.param, numCards), cards.end ()); break;
+                case DEAL:
+                    for (std::size_t index {0U}; index < numCards; ++index) {
+                        next[mulMod (index, toResidue (action.param, numCards), numCards)] = cards[index];
+                    }
+                    std::swap (cards, next);
+                    break;
+                default: throw std::runtime_error ("Unknown action type.");
+            }
+        }
+    }
+    return cards;
+}
+
+// Cross-checks the affine engine against the simulator on small decks whose sizes are coprime to every increment.
+void verify (std::vector<Action> const& commands) {
+    for (unsigned long long numCards : {10007ULL, 10009ULL, 10037ULL, 4099ULL, 1009ULL}) {
+        for (unsigned long long repetitions : {1ULL, 2ULL, 7ULL}) {
+            std::vector<unsigned long long> cards = simulate (commands, numCards, repetitions);
+            AffineShuffle forward = power (compile (commands, numCards), repetitions);
+            AffineShuffle backward = inverse (forward);
+            for (unsigned long long position {0U}; position < numCards; ++position) {
+                if (forward.apply (cards[position]) != position || backward.apply (position) != cards[position]) {
+                    throw std::runtime_error ("Mismatch with " + std::to_string (numCards) + " cards and " + std::to_string (repetitions) + " repetitions at position " + std::to_string (position));
+                }
+            }
+        }
+    }
+    std::cout << "Affine shuffle matches simulation.\n";
+}
+
+int main (int argc, char* argv[]) {
     std::vector<Action> commands = getInput ();
-    Deck deck = getFactoryOrder (PART1_LAST_CARD);
-    shuffle (commands, deck);
-    std::cout << findCard (deck, 2019) << "\n";
-
-    std::vector<Action> simplified = simplify (commands, PART2_NUM_CARDS, TIMES_TO_DO);
-    std::cout << simplified << "\n";
-    std::cout << findPositionBeforeAllSteps (2020, simplified, 1, PART2_NUM_CARDS) << "\n";
-    //std::cout << findPositionBeforeAllSteps (2020, commands, TIMES_TO_DO) << "\n";
+    if (argc > 1 && std::strcmp (argv[1], "--verify") == 0) {
+        verify (commands);
+    }
+    std::cout << positionOfCard (commands, PART1_LAST_CARD, 1ULL, 2019ULL) << "\n";
+    std::cout << cardAtPosition (commands, PART2_NUM_CARDS, TIMES_TO_DO, 2020ULL) << "\n";
     return 0;
 }
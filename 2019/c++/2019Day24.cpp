@@ -6,7 +6,10 @@
 #include <string>
 #include <cassert>
 #include <array>
-#include <unordered_set>
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <cstdlib>
 
 #include "utilities.hpp"
 
@@ -20,52 +23,9 @@ constexpr unsigned int STAY_ALIVE_COUNT_MAX = 1;
 constexpr unsigned int GROW_COUNT_MIN = 1;
 constexpr unsigned int GROW_COUNT_MAX = 2;
 constexpr unsigned int PART2_ITERATIONS = 200;
-constexpr unsigned int ALL_DEPTHS = PART2_ITERATIONS * 2 + 3;
-constexpr unsigned int MIDDLE_DEPTH = ALL_DEPTHS / 2;
 constexpr std::size_t MIDDLE_TILE = SIZE / 2;
 
 using State = std::array<std::array<bool, SIZE>, SIZE>;
-using RecursiveState = std::array<std::array<std::array<bool, SIZE>, SIZE>, PART2_ITERATIONS * 2 + 3>;
-
-std::ostream & operator<< (std::ostream & out, State const& state) {
-    for (std::size_t row {0U}; row < SIZE; ++row) {
-        for (std::size_t col {0U}; col < SIZE; ++col) {
-            if (row == MIDDLE_TILE && col == MIDDLE_TILE) { std::cout << '?'; }
-            else if (state[row][col] == BUG_BOOL) { std::cout << BUG_CHAR; }
-            else { std::cout << EMPTY_CHAR; }
-        }
-        std::cout << "\n";
-    }
-    return out;
-}
-
-unsigned int countBugs (State const& state) {
-    unsigned int count {0U};
-    for (std::size_t row {0U}; row < SIZE; ++row) {
-        for (std::size_t col {0U}; col < SIZE; ++col) {
-            if (state[row][col] == BUG_BOOL) { ++count; }
-        }
-    }
-    return count;
-}
-
-unsigned int countBugs (RecursiveState const& state) {
-    unsigned int count {0U};
-    for (std::size_t depth {0U}; depth < ALL_DEPTHS; ++depth) {
-        count += countBugs (state[depth]);
-    }
-    return count;
-}
-
-std::ostream & operator<< (std::ostream & out, RecursiveState const& state) {
-    for (std::size_t depth {0U}; depth < ALL_DEPTHS; ++depth) {
-        if (countBugs (state[depth]) > 0) {
-            out << "Depth " << (int)depth - (int)MIDDLE_DEPTH << ":\n";
-            out << state[depth] << "\n";
-        }
-    }
-    return out;
-}
 
 State getInput () {
     State initial;
@@ -85,33 +45,6 @@ State getInput () {
     return initial;
 }
 
-unsigned int getNeighborhood (State const& current, std::size_t row, std::size_t col) {
-    unsigned int count {0U};
-    if (row > 0 && current[row - 1][col] == BUG_BOOL) { ++count; }
-    if (row < SIZE - 1 && current[row + 1][col] == BUG_BOOL) { ++count; }
-    if (col > 0 && current[row][col - 1] == BUG_BOOL) { ++count; }
-    if (col < SIZE - 1 && current[row][col + 1] == BUG_BOOL) { ++count; }
-    return count;
-}
-
-State nextState (State const& current) {
-    State result;
-    for (std::size_t row {0U}; row < SIZE; ++row) {
-        for (std::size_t col {0U}; col < SIZE; ++col) {
-            unsigned int neighborhood = getNeighborhood (current, row, col);
-            if (current[row][col] == BUG_BOOL) {
-                if (neighborhood >= STAY_ALIVE_COUNT_MIN && neighborhood <= STAY_ALIVE_COUNT_MAX) { result[row][col] = BUG_BOOL; }
-                else { result[row][col] = EMPTY_BOOL; }
-            }
-            else {
-                if (neighborhood >= GROW_COUNT_MIN && neighborhood <= GROW_COUNT_MAX) { result[row][col] = BUG_BOOL; }
-                else { result[row][col] = EMPTY_BOOL; }
-            }
-        }
-    }
-    return result;
-}
-
 unsigned int biodiversity (State const& current) {
     unsigned int total {0U};
     unsigned int nextVal {1U};
@@ -124,155 +57,154 @@ unsigned int biodiversity (State const& current) {
     return total;
 }
 
-unsigned int part1 (State const& initial) {
-    std::unordered_set<unsigned int> seen;
-    State current (initial);
-    seen.insert (biodiversity (current));
-    while (true) {
-        current = nextState (current);
-        unsigned int bio = biodiversity (current);
-        if (seen.count (bio) == 1) { return bio; }
-        seen.insert (bio);
-    }
-}
-
-unsigned int getRecursiveNorthNeighbors (RecursiveState const& current, std::size_t depth, std::size_t row, std::size_t col) {
-    unsigned int count {0U};
-    if (row == 0) {
-        // If in top row, we need to look just above middle tile in lower depth.
-        if (current[depth - 1][MIDDLE_TILE - 1][MIDDLE_TILE] == BUG_BOOL) { ++count; }
-    }
-    else if (row == MIDDLE_TILE + 1 && col == MIDDLE_TILE) {
-        // If just below middle tile, we need to look at all parts of bottom row in higher depth.
-        for (std::size_t otherCol {0U}; otherCol < SIZE; ++otherCol) {
-            if (current[depth + 1][SIZE - 1][otherCol] == BUG_BOOL) { ++count; }
-        }
-    }
-    else { 
-        // Just look at the cell above it at the same depth.
-        if (current[depth][row - 1][col] == BUG_BOOL) { ++count; }
-    }
-    return count;
-}
-
-unsigned int getRecursiveSouthNeighbors (RecursiveState const& current, std::size_t depth, std::size_t row, std::size_t col) {
-    unsigned int count {0U};
-    if (row == SIZE - 1) {
-        // If in bottom row, we need to look just below middle tile in lower depth.
-        if (current[depth - 1][MIDDLE_TILE + 1][MIDDLE_TILE] == BUG_BOOL) { ++count; }
-    }
-    else if (row == MIDDLE_TILE - 1 && col == MIDDLE_TILE) {
-        // If just above middle tile, we ened to look at all parts of top row in higher depth.
-        for (std::size_t otherCol {0U}; otherCol < SIZE; ++otherCol) {
-            if (current[depth + 1][0][otherCol] == BUG_BOOL) { ++count; }
-        }
-    }
-    else { 
-        // Just look at the cell below it at the same depth.
-        if (current[depth][row + 1][col] == BUG_BOOL) { ++count; }
-    }
-    return count;
-}
-
-unsigned int getRecursiveWestNeighbors (RecursiveState const& current, std::size_t depth, std::size_t row, std::size_t col) {
-    unsigned int count {0U};
-    if (col == 0) {
-        // If in leftmost col, we need to look just left of middle tile in lower depth.
-        if (current[depth - 1][MIDDLE_TILE][MIDDLE_TILE - 1] == BUG_BOOL) { ++count; }
-    }
-    else if (row == MIDDLE_TILE && col == MIDDLE_TILE + 1) {
-        // If just right of middle tile, we need to look at all parts of rightmost col in higher depth.
-        for (std::size_t otherRow {0U}; otherRow < SIZE; ++otherRow) {
-            if (current[depth + 1][otherRow][SIZE - 1] == BUG_BOOL) { ++count; }
+// A whole level packed into one integer, with the cell at (row, col) in bit row * SIZE + col.
+// That makes a level's number the same as its biodiversity rating.
+using Layout = std::uint32_t;
+constexpr unsigned int CELLS = SIZE * SIZE;
+constexpr unsigned int MIDDLE_CELL = MIDDLE_TILE * SIZE + MIDDLE_TILE;
+constexpr Layout ALL_CELLS = (1U << CELLS) - 1U;
+
+inline Layout cellBit (std::size_t row, std::size_t col) { return 1U << (row * SIZE + col); }
+
+constexpr Layout TOP_ROW = (1U << SIZE) - 1U;
+constexpr Layout BOTTOM_ROW = TOP_ROW << (CELLS - SIZE);
+constexpr Layout LEFT_COL = 0b0000100001000010000100001U;
+constexpr Layout RIGHT_COL = LEFT_COL << (SIZE - 1);
+
+// How many neighbors each cell of a level has, counted for all cells at once:
+//   bit c of atLeast[k] says that cell c has more than k.
+// Counting stops at 3, since no rule cares about more than 2.
+static_assert (STAY_ALIVE_COUNT_MAX < 3 && GROW_COUNT_MAX < 3, "neighbor counts saturate at 3");
+struct NeighborCounts {
+    std::array<Layout, 3> atLeast {};
+
+    // Adds one neighbor to every cell whose bit is set.
+    inline void add (Layout cells) {
+        atLeast[2] |= atLeast[1] & cells;
+        atLeast[1] |= atLeast[0] & cells;
+        atLeast[0] |= cells;
+    }
+
+    // Adds another set of counts to this one.
+    inline void add (NeighborCounts const& other) {
+        atLeast[2] |= other.atLeast[2] | (atLeast[1] & other.atLeast[0]) | (atLeast[0] & other.atLeast[1]);
+        atLeast[1] |= other.atLeast[1] | (atLeast[0] & other.atLeast[0]);
+        atLeast[0] |= other.atLeast[0];
+    }
+
+    // Which cells have exactly that many neighbors.
+    inline Layout exactly (unsigned int count) const {
+        Layout atLeastCount = count == 0U ? ALL_CELLS : atLeast[count - 1];
+        return atLeastCount & ~atLeast[count];
+    }
+};
+
+// Which cells can hold bugs: all of them, except the middle when it is the level inside.
+inline Layout usableCells (bool recursive) {
+    return recursive ? ALL_CELLS & ~(1U << MIDDLE_CELL) : ALL_CELLS;
+}
+
+Layout packLayout (State const& state) {
+    return biodiversity (state);
+}
+
+// Gives one cell as many neighbors as there are bugs along an edge of the level inside.
+inline void addEdge (NeighborCounts& counts, Layout edgeBugs, Layout cell) {
+    if (edgeBugs == 0U) { return; }
+    edgeBugs &= edgeBugs - 1U;
+    counts.atLeast[0] |= cell;
+    if (edgeBugs == 0U) { return; }
+    edgeBugs &= edgeBugs - 1U;
+    counts.atLeast[1] |= cell;
+    if (edgeBugs == 0U) { return; }
+    counts.atLeast[2] |= cell;
+}
+
+// A neighbor one row up is a shift by a whole row, and one column over is a shift by one bit that must not wrap.
+// Edge cells also touch one cell of the level outside, and the four cells around the middle touch a whole edge of the level inside.
+Layout nextLayout (Layout usable, Layout outer, Layout current, Layout inner) {
+    NeighborCounts counts;
+    counts.add ((current << SIZE) & ALL_CELLS);
+    counts.add (current >> SIZE);
+    counts.add ((current << 1) & ~LEFT_COL & ALL_CELLS);
+    counts.add ((current >> 1) & ~RIGHT_COL);
+    if (outer & cellBit (MIDDLE_TILE - 1, MIDDLE_TILE)) { counts.add (TOP_ROW); }
+    if (outer & cellBit (MIDDLE_TILE + 1, MIDDLE_TILE)) { counts.add (BOTTOM_ROW); }
+    if (outer & cellBit (MIDDLE_TILE, MIDDLE_TILE - 1)) { counts.add (LEFT_COL); }
+    if (outer & cellBit (MIDDLE_TILE, MIDDLE_TILE + 1)) { counts.add (RIGHT_COL); }
+    if (inner != 0U) {
+        NeighborCounts fromInner;
+        addEdge (fromInner, inner & TOP_ROW, cellBit (MIDDLE_TILE - 1, MIDDLE_TILE));
+        addEdge (fromInner, inner & BOTTOM_ROW, cellBit (MIDDLE_TILE + 1, MIDDLE_TILE));
+        addEdge (fromInner, inner & LEFT_COL, cellBit (MIDDLE_TILE, MIDDLE_TILE - 1));
+        addEdge (fromInner, inner & RIGHT_COL, cellBit (MIDDLE_TILE, MIDDLE_TILE + 1));
+        counts.add (fromInner);
+    }
+    Layout survive {0U};
+    for (unsigned int count {STAY_ALIVE_COUNT_MIN}; count <= STAY_ALIVE_COUNT_MAX; ++count) { survive |= counts.exactly (count); }
+    Layout grow {0U};
+    for (unsigned int count {GROW_COUNT_MIN}; count <= GROW_COUNT_MAX; ++count) { grow |= counts.exactly (count); }
+    return ((current & survive) | (~current & grow)) & usable;
+}
+
+// Every layout is a 25-bit number, so the ones already seen fit in a flat 4 MB bitset.
+Layout findFirstRepeat (State const& initial) {
+    std::vector<bool> seen (1U << CELLS, false);
+    Layout current = packLayout (initial);
+    while (!seen[current]) {
+        seen[current] = true;
+        current = nextLayout (usableCells (false), 0U, current, 0U);
+    }
+    return current;
+}
+
+// Only the populated levels are kept, outermost first, plus a blank one at either end while it might fill in.
+class RecursiveBugs {
+public:
+    RecursiveBugs (State const& initial)
+    : m_usable {usableCells (true)}, m_levels {packLayout (initial) & m_usable}, m_next {} {
+    }
+
+    void step () {
+        if (m_levels.front () != 0U) { m_levels.push_front (0U); }
+        if (m_levels.back () != 0U) { m_levels.push_back (0U); }
+        m_next.resize (m_levels.size ());
+        Layout outer {0U};
+        auto out = m_next.begin ();
+        for (auto level = m_levels.begin (); level != m_levels.end (); ++level, ++out) {
+            Layout inner = std::next (level) == m_levels.end () ? 0U : *std::next (level);
+            *out = nextLayout (m_usable, outer, *level, inner);
+            outer = *level;
         }
+        std::swap (m_levels, m_next);
+        while (m_levels.size () > 1 && m_levels.front () == 0U) { m_levels.pop_front (); }
+        while (m_levels.size () > 1 && m_levels.back () == 0U) { m_levels.pop_back (); }
     }
-    else { 
-        // Just look at the cell left of it at the same depth.
-        if (current[depth][row][col - 1] == BUG_BOOL) { ++count; }
-    }
-    return count;
-}
 
-unsigned int getRecursiveEastNeighbors (RecursiveState const& current, std::size_t depth, std::size_t row, std::size_t col) {
-    unsigned int count {0U};
-    if (col == SIZE - 1) {
-        // If in rightmost col, we need to look just right of middle tile in lower depth.
-        if (current[depth - 1][MIDDLE_TILE][MIDDLE_TILE + 1] == BUG_BOOL) { ++count; }
+    unsigned long long countBugs () const {
+        unsigned long long count {0ULL};
+        for (Layout level : m_levels) { count += __builtin_popcount (level); }
+        return count;
     }
-    else if (row == MIDDLE_TILE && col == MIDDLE_TILE - 1) {
-        // If just left of middle tile, we need to look at all parts of leftmost col in higher depth.
-        for (std::size_t otherRow {0U}; otherRow < SIZE; ++otherRow) {
-            if (current[depth + 1][otherRow][0] == BUG_BOOL) { ++count; }
-        }
-    }
-    else { 
-        // Just look at the cell right of it at the same depth.
-        if (current[depth][row][col + 1] == BUG_BOOL) { ++count; }
-    }
-    return count;
-}
 
-unsigned int getRecursiveNeighborhood (RecursiveState const& current, std::size_t depth, std::size_t row, std::size_t col) {
-    return getRecursiveNorthNeighbors (current, depth, row, col)
-        + getRecursiveSouthNeighbors (current, depth, row, col)
-        + getRecursiveWestNeighbors (current, depth, row, col)
-        + getRecursiveEastNeighbors (current, depth, row, col);
-}
+private:
+    Layout m_usable;
+    std::deque<Layout> m_levels;
+    std::deque<Layout> m_next;
+};
 
-RecursiveState nextRecursiveState (RecursiveState const& current) {
-    RecursiveState result;
-    for (std::size_t depth {1U}; depth < ALL_DEPTHS - 1; ++depth) {
-        for (std::size_t row {0U}; row < SIZE; ++row) {
-            for (std::size_t col {0U}; col < SIZE; ++col) {
-                unsigned int neighborhood = getRecursiveNeighborhood (current, depth, row, col);
-                if (row == MIDDLE_TILE && col == MIDDLE_TILE) {
-                    result[depth][row][col] = EMPTY_BOOL;
-                }
-                else if (current[depth][row][col] == BUG_BOOL) {
-                    if (neighborhood >= STAY_ALIVE_COUNT_MIN && neighborhood <= STAY_ALIVE_COUNT_MAX) { result[depth][row][col] = BUG_BOOL; }
-                    else { result[depth][row][col] = EMPTY_BOOL; }
-                }
-                else {
-                    if (neighborhood >= GROW_COUNT_MIN && neighborhood <= GROW_COUNT_MAX) { result[depth][row][col] = BUG_BOOL; }
-                    else { result[depth][row][col] = EMPTY_BOOL; }
-                }
-            }
-        }
-    }
-    return result;
-}
-
-unsigned int part2 (State const& initial) { 
-    RecursiveState current;
-    for (std::size_t depth {0U}; depth < ALL_DEPTHS; ++depth) {
-        for (std::size_t row {0U}; row < SIZE; ++row) {
-            for (std::size_t col {0U}; col < SIZE; ++col) {
-                current[depth][row][col] = EMPTY_BOOL;
-            }
-        }
-    }
-    current[MIDDLE_DEPTH] = initial;
-    for (unsigned int iteration {0U}; iteration < PART2_ITERATIONS; ++iteration) {
-        current = nextRecursiveState (current);
-        //std::cout << "After " << iteration + 1 << " iterations:\n" << current << "\n\n";
+unsigned long long countRecursiveBugs (State const& initial, unsigned long long minutes) {
+    RecursiveBugs bugs {initial};
+    for (unsigned long long minute {0ULL}; minute < minutes; ++minute) {
+        bugs.step ();
     }
-    return countBugs (current);
+    return bugs.countBugs ();
 }
 
-int main () {
+int main (int argc, char* argv[]) {
     State initial = getInput ();
-    std::cout << part1 (initial) << "\n";
-    std::cout << part2 (initial) << "\n";
-    /*
-    RecursiveState start;
-    start[MIDDLE_DEPTH] = initial;
-    std::cout << start << "\n\n";
-    RecursiveState after1 = nextRecursiveState (start);
-    std::cout << after1 << "\n\n";
-    RecursiveState after2 = nextRecursiveState (after1);
-    std::cout << after2 << "\n\n";
-    RecursiveState after3 = nextRecursiveState (after2);
-    std::cout << after3 << "\n\n";
-    */
+    unsigned long long minutes = argc > 1 ? std::strtoull (argv[1], nullptr, 10) : PART2_ITERATIONS;
+    std::cout << findFirstRepeat (initial) << "\n";
+    std::cout << countRecursiveBugs (initial, minutes) << "\n";
     return 0;
 }
@@ -131,6 +131,7 @@ public:
     inline unsigned int getInstPointer () const { return m_instPointer; }
     inline int getNumber (unsigned int pos) const { return readMemoryAddress (pos); }
     inline NumbersList getOutputs () const { return m_outputs; }
+    inline Number getLastOutput () const { return m_outputs.back (); }
     inline NumbersList getNewOutputs () {
         NumbersList result;
         if (m_outputs.size () > m_outputPointer) {
@@ -6,8 +6,10 @@
 #include <cstdio>
 #include <array>
 #include <numeric>
+#include <string>
 
 #include "utilities.hpp"
+#include "recurrence.hpp"
 
 /// The timer that a fish returns to after reproducing.
 constexpr unsigned int COUNTER_RESET = 6U;
@@ -50,15 +52,49 @@ Counts iterate (Counts const& original, unsigned int times) {
     return previous;
 }
 
+/// \brief Expresses the fish growth simulation as a linear recurrence on the timer counts.
+/// \return A recurrence in which entry i is the number of fish with timer i.
+LinearRecurrence makeRecurrence () {
+    LinearRecurrence recurrence (ARRAY_LENGTH);
+    for (unsigned int index {1U}; index < ARRAY_LENGTH; ++index) {
+        recurrence.addTransition (index, index - 1);
+    }
+    recurrence.addTransition (0U, COUNTER_RESET);
+    recurrence.addTransition (0U, COUNTER_START);
+    return recurrence;
+}
+
+/// \brief Adds up some counts, possibly modulo some number.
+/// \param[in] counts The counts.
+/// \param[in] modulus The modulus, or 0 for none.
+/// \return The total.
+unsigned long long total (LinearRecurrence::State const& counts, unsigned long long modulus) {
+    unsigned long long sum {0ULL};
+    for (unsigned long long count : counts) {
+        sum = modulus == 0ULL ? sum + count : (sum + count) % modulus;
+    }
+    return sum;
+}
+
 /// \brief Runs the prorgram.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv Optionally a (possibly enormous) number of days, and a modulus to count the fish modulo.
 /// \return Always 0.
-int main () {
+int main (int argc, char* argv[]) {
     constexpr unsigned int PART1_ITERATIONS = 80U;
     constexpr unsigned int PART2_ITERATIONS = 256U;
     Counts original = getInput ();
-    Counts answer = iterate (original, PART1_ITERATIONS);
-    std::cout << std::accumulate (answer.begin (), answer.end (), 0ULL) << "\n";
-    Counts answer2 = iterate (answer, PART2_ITERATIONS - PART1_ITERATIONS);
-    std::cout << std::accumulate (answer2.begin (), answer2.end (), 0ULL) << "\n";
+    LinearRecurrence const recurrence {makeRecurrence ()};
+    LinearRecurrence::State start (original.begin (), original.end ());
+    LinearRecurrence::State answer = recurrence.advance (start, PART1_ITERATIONS);
+    std::cout << total (answer, 0ULL) << "\n";
+    LinearRecurrence::State answer2 = recurrence.advance (answer, PART2_ITERATIONS - PART1_ITERATIONS);
+    std::cout << total (answer2, 0ULL) << "\n";
+
+    if (argc > 1) {
+        unsigned long long days {std::stoull (argv[1])};
+        unsigned long long modulus {argc > 2 ? std::stoull (argv[2]) : 0ULL};
+        std::cout << total (recurrence.advance (start, days, modulus), modulus) << "\n";
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -8,8 +8,11 @@
 #include <string>
 #include <stack>
 #include <algorithm>
+#include <random>
+#include <cstring>
 
 #include "utilities.hpp"
+#include "bitboard.hpp"
 
 /// The row/column at which we start storing real data.  (There's a dummy row/column before it.)
 constexpr unsigned int REAL_GRID_START = 1U;
@@ -142,12 +145,149 @@ unsigned int stepUntilAllFlash (Grid<unsigned int> & levels) {
     }
 }
 
+/// The number of bit-planes in an energy level: at most 9, plus 1, plus one from each of 8 flashing neighbors.
+constexpr unsigned int ENERGY_PLANES = 5U;
+
+/// Octopus energy levels of any size of grid, as a bit-sliced counter, where each flash cascade is a series
+///   of waves that each flash every ready octopus at once.
+class OctopusBitboards {
+public:
+    /// \brief Constructs a grid of octopi that all have no energy.
+    /// \param[in] rows The number of rows.
+    /// \param[in] cols The number of columns.
+    OctopusBitboards (std::size_t rows, std::size_t cols)
+        : m_levels (ENERGY_PLANES, Bitboard (rows, cols)),
+          m_everywhere (rows, cols),
+          m_flashed (rows, cols),
+          m_wave (rows, cols),
+          m_neighbors (rows, cols),
+          m_carry (rows, cols),
+          m_scratch (rows, cols) {
+        m_everywhere.invert ();
+    }
+
+    /// \brief Constructs a grid from the puzzle's energy levels.
+    /// \param[in] levels The energy levels.
+    OctopusBitboards (Grid<unsigned int> const& levels)
+        : OctopusBitboards (REAL_GRID_LAST - REAL_GRID_START + 1U, REAL_GRID_LAST - REAL_GRID_START + 1U) {
+        for (unsigned int row {REAL_GRID_START}; row <= REAL_GRID_LAST; ++row) {
+            for (unsigned int col {REAL_GRID_START}; col <= REAL_GRID_LAST; ++col) {
+                setLevel (row - REAL_GRID_START, col - REAL_GRID_START, levels[row][col]);
+            }
+        }
+    }
+
+    /// \brief Sets the energy level of one octopus.
+    /// \param[in] row Its row.
+    /// \param[in] col Its column.
+    /// \param[in] level Its energy level, which must be less than the flash level.
+    void setLevel (std::size_t row, std::size_t col, unsigned int level) {
+        assert (level < FLASH_ENERGY_LEVEL);
+        for (unsigned int plane {0U}; plane < ENERGY_PLANES; ++plane) {
+            m_levels[plane].set (row, col, (level >> plane) & 1U);
+        }
+    }
+
+    /// \brief Does one time-step of octopus energy level changes.
+    /// \return The number of octopi that flashed during this time-step.
+    std::size_t doStep () {
+        addOne (m_levels, m_everywhere, m_carry, m_scratch);
+        m_flashed.clear ();
+        while (true) {
+            // Levels here are below 32, so being at least 10 means having the 16 bit or the 8 bit and one of 4 or 2.
+            m_wave = m_levels[1];
+            m_wave |= m_levels[2];
+            m_wave &= m_levels[3];
+            m_wave |= m_levels[4];
+            m_wave.andNot (m_flashed);
+            if (!m_wave.any ()) { break; }
+            m_flashed |= m_wave;
+            for (int rowStep {-1}; rowStep <= 1; ++rowStep) {
+                for (int colStep {-1}; colStep <= 1; ++colStep) {
+                    if (rowStep == 0 && colStep == 0) { continue; }
+                    m_wave.shiftInto (m_neighbors, rowStep, colStep, false);
+                    addOne (m_levels, m_neighbors, m_carry, m_scratch);
+                }
+            }
+        }
+        for (Bitboard& plane : m_levels) {
+            plane.andNot (m_flashed);
+        }
+        return m_flashed.count ();
+    }
+
+    /// \brief Checks whether every octopus flashed during the last time-step.
+    /// \return True if they all did.
+    bool allFlashed () const {
+        return m_flashed == m_everywhere;
+    }
+
+private:
+    BitSlicedCounter m_levels;
+    Bitboard m_everywhere;
+    /// The octopi that have flashed so far this time-step.
+    Bitboard m_flashed;
+    Bitboard m_wave;
+    Bitboard m_neighbors;
+    Bitboard m_carry;
+    Bitboard m_scratch;
+};
+
+/// \brief Runs the bitboard simulation through many time-steps.
+/// \param[inout] octopi The octopus energy levels.
+/// \param[in] steps The number of time-steps to run.
+/// \return The total number of flashes that occurred among all steps.
+std::size_t doManySteps (OctopusBitboards & octopi, unsigned int steps) {
+    std::size_t total {0U};
+    for (unsigned int count {0U}; count < steps; ++count) {
+        total += octopi.doStep ();
+    }
+    return total;
+}
+
+/// \brief Runs the bitboard simulation until all octopi flash at the same time.
+/// \param[inout] octopi The octopus energy levels.
+/// \return The number of time-steps until they all flash simultaneously.
+unsigned int stepUntilAllFlash (OctopusBitboards & octopi) {
+    unsigned int count {0U};
+    do {
+        octopi.doStep ();
+        ++count;
+    } while (!octopi.allFlashed ());
+    return count;
+}
+
+/// \brief Times the bitboard simulation on a large grid of random energy levels.
+/// \param[in] rows The number of rows.
+/// \param[in] cols The number of columns.
+/// \param[in] steps How many time-steps to run.
+void benchmark (std::size_t rows, std::size_t cols, unsigned int steps) {
+    OctopusBitboards octopi (rows, cols);
+    std::mt19937_64 generator {2021U};
+    std::uniform_int_distribution<unsigned int> levels {MIN_ENERGY_LEVEL, FLASH_ENERGY_LEVEL - 1U};
+    for (std::size_t row {0U}; row < rows; ++row) {
+        for (std::size_t col {0U}; col < cols; ++col) {
+            octopi.setLevel (row, col, levels (generator));
+        }
+    }
+    std::size_t flashes {0U};
+    double rate = measureStepsPerSecond (steps, [&] () { flashes += octopi.doStep (); });
+    std::cout << flashes << " flashes at " << rate << " steps/sec\n";
+}
+
 /// \brief Runs the prorgram.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv Optionally --benchmark followed by rows, columns and time-steps, to time a big random grid instead.
 /// \return Always 0.
-int main () {
+int main (int argc, char* argv[]) {
+    if (argc > 4 && std::strcmp (argv[1], "--benchmark") == 0) {
+        benchmark (std::stoul (argv[2]), std::stoul (argv[3]), std::stoul (argv[4]));
+        return 0;
+    }
     Grid<unsigned int> levels = getInput ();
-    Grid<unsigned int> copy (levels);
-    std::cout << doManySteps (copy, 100U) << "\n";
-    std::cout << stepUntilAllFlash (levels) << "\n";
+    OctopusBitboards first (levels);
+    std::cout << doManySteps (first, 100U) << "\n";
+    OctopusBitboards second (levels);
+    std::cout << stepUntilAllFlash (second) << "\n";
     return 0;
-}
\ No newline at end of file
+}
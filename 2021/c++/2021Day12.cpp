@@ -8,6 +8,8 @@
 #include <string>
 #include <stack>
 #include <algorithm>
+#include <cstdint>
+#include <stdexcept>
 
 #include "utilities.hpp"
 
@@ -143,11 +145,139 @@ unsigned long findPaths2 (EdgeList const& edges) {
     return count;
 }
 
+/// A cave graph compiled down to only its small caves.  Since two big caves can never be adjacent (or there
+///   would be infinitely many paths), every step through a big cave goes from one small cave to another, so
+///   each pair of small caves is joined by some number of one- or two-step routes.
+struct CompiledCaves {
+    /// The names of the small caves, indexed from 0.
+    std::vector<Cave> names;
+    /// The index of START.
+    std::size_t start;
+    /// The index of END.
+    std::size_t end;
+    /// For each small cave, the small caves reachable from it and in how many ways.
+    std::vector<std::vector<std::pair<std::size_t, unsigned long long>>> routes;
+};
+
+/// \brief Interns cave names and collapses big caves into weighted routes between small ones.
+/// \param[in] edges A collection of edges.
+/// \return The compiled graph.
+CompiledCaves compileCaves (EdgeList const& edges) {
+    std::unordered_map<Cave, std::size_t> smallIndices;
+    std::unordered_map<Cave, std::vector<std::size_t>> bigNeighbors;
+    auto intern = [&] (Cave const& cave) {
+        if (isSmallCave (cave) && smallIndices.find (cave) == smallIndices.end ()) {
+            smallIndices.insert ({cave, smallIndices.size ()});
+        }
+    };
+    intern (START);
+    intern (END);
+    for (Edge const& edge : edges) {
+        intern (edge.first);
+        intern (edge.second);
+    }
+    if (smallIndices.size () > 57U) {
+        throw std::runtime_error ("Too many small caves to track visits in a bitmask.");
+    }
+
+    CompiledCaves caves {std::vector<Cave> (smallIndices.size ()), smallIndices.at (START), smallIndices.at (END), {}};
+    for (std::pair<const Cave, std::size_t> const& small : smallIndices) {
+        caves.names[small.second] = small.first;
+    }
+    std::vector<std::vector<unsigned long long>> ways (caves.names.size (), std::vector<unsigned long long> (caves.names.size (), 0ULL));
+    for (Edge const& edge : edges) {
+        bool firstSmall {isSmallCave (edge.first)};
+        bool secondSmall {isSmallCave (edge.second)};
+        if (firstSmall && secondSmall) {
+            ++ways[smallIndices.at (edge.first)][smallIndices.at (edge.second)];
+            ++ways[smallIndices.at (edge.second)][smallIndices.at (edge.first)];
+        }
+        else if (firstSmall) {
+            bigNeighbors[edge.second].push_back (smallIndices.at (edge.first));
+        }
+        else if (secondSmall) {
+            bigNeighbors[edge.first].push_back (smallIndices.at (edge.second));
+        }
+        else {
+            throw std::runtime_error ("Two big caves are connected, so there are infinitely many paths.");
+        }
+    }
+    for (std::pair<const Cave, std::vector<std::size_t>> const& big : bigNeighbors) {
+        for (std::size_t from : big.second) {
+            for (std::size_t to : big.second) {
+                ++ways[from][to];
+            }
+        }
+    }
+
+    caves.routes.resize (caves.names.size ());
+    for (std::size_t from {0U}; from < caves.names.size (); ++from) {
+        for (std::size_t to {0U}; to < caves.names.size (); ++to) {
+            if (ways[from][to] != 0ULL && to != caves.start) {
+                caves.routes[from].push_back ({to, ways[from][to]});
+            }
+        }
+    }
+    return caves;
+}
+
+/// Counts paths through a compiled cave graph by memoized search over the current cave, the set of small
+///   caves already visited, and whether the one allowed repeat visit has been used up.
+class PathCounter {
+public:
+    /// \brief Constructs a counter.
+    /// \param[in] caves The graph, which must outlive the counter.
+    PathCounter (CompiledCaves const& caves) : m_caves {caves}, m_memo {} {}
+
+    /// \brief Counts the legal paths from START to END.
+    /// \param[in] allowOneRepeat True if a single small cave other than START may be visited twice.
+    /// \return The number of paths.
+    unsigned long long countPaths (bool allowOneRepeat) {
+        m_memo.clear ();
+        return countFrom (m_caves.start, 0ULL, !allowOneRepeat);
+    }
+
+private:
+    /// \brief Counts the ways to finish a path.
+    /// \param[in] cave The small cave the path is in.
+    /// \param[in] visited A bit for each small cave the path has visited.
+    /// \param[in] repeated Whether or not the path has already visited a small cave twice.
+    /// \return The number of ways to reach END from here.
+    unsigned long long countFrom (std::size_t cave, std::uint64_t visited, bool repeated) {
+        std::uint64_t key {((visited << 6 | cave) << 1) | repeated};
+        auto const iter = m_memo.find (key);
+        if (iter != m_memo.end ()) {
+            return iter->second;
+        }
+        unsigned long long total {0ULL};
+        for (std::pair<std::size_t, unsigned long long> const& route : m_caves.routes[cave]) {
+            std::size_t next {route.first};
+            std::uint64_t bit {1ULL << next};
+            if (next == m_caves.end) {
+                total += route.second;
+            }
+            else if ((visited & bit) == 0ULL) {
+                total += route.second * countFrom (next, visited | bit, repeated);
+            }
+            else if (!repeated) {
+                total += route.second * countFrom (next, visited, true);
+            }
+        }
+        m_memo.insert ({key, total});
+        return total;
+    }
+
+    CompiledCaves const& m_caves;
+    std::unordered_map<std::uint64_t, unsigned long long> m_memo;
+};
+
 /// \brief Runs the prorgram.
 /// \return Always 0.
 int main () {
     EdgeList edges = getInput ();
-    std::cout << findPaths (edges) << "\n";
-    std::cout << findPaths2 (edges) << "\n";
+    CompiledCaves caves = compileCaves (edges);
+    PathCounter counter (caves);
+    std::cout << counter.countPaths (false) << "\n";
+    std::cout << counter.countPaths (true) << "\n";
     return 0;
-}
\ No newline at end of file
+}
@@ -6,8 +6,14 @@
 #include <unordered_map>
 #include <string>
 #include <cassert>
+#include <vector>
+#include <array>
+#include <deque>
+#include <algorithm>
+#include <limits>
 
 #include "utilities.hpp"
+#include "recurrence.hpp"
 
 /// Two characters beside each other in a (very long eventually) string.
 using Pair = std::pair<char, char>;
@@ -30,7 +36,7 @@ struct Problem {
 /// \return The output stream.
 /// \post The information in the map has been inserted into the output stream.
 std::ostream& operator<< (std::ostream & out, std::unordered_map<Pair, unsigned long> const& counts) {
-    for (std::pair<Pair, unsigned long> const& count : counts) {
+    for (std::pair<const Pair, unsigned long> const& count : counts) {
         out << count.first.first << count.first.second << ": " << count.second << "\n";
     }
     return out;
@@ -78,7 +84,7 @@ Problem iterate (Problem const& orig) {
     revised.rules = orig.rules;
     revised.firstLetter = orig.firstLetter;
     revised.lastLetter = orig.lastLetter;
-    for (std::pair<Pair, unsigned long> const& existing : orig.counts) {
+    for (std::pair<const Pair, unsigned long> const& existing : orig.counts) {
         Pair const& currentPair = existing.first;
         char middle = orig.rules.at (currentPair);
         Pair first = Pair {currentPair.first, middle};
@@ -140,7 +146,7 @@ unsigned long correctElementCount (char element, unsigned long count, Problem co
 /// \return The difference.
 unsigned long countDiff (Problem const& prob) {
     std::unordered_map<char, unsigned long> elements;
-    for (std::pair<Pair, unsigned long> const& count : prob.counts) {
+    for (std::pair<const Pair, unsigned long> const& count : prob.counts) {
         if (elements.find (count.first.first) == elements.end ()) {
             elements.insert ({count.first.first, count.second});
         }
@@ -159,7 +165,7 @@ unsigned long countDiff (Problem const& prob) {
     unsigned long max = 0UL;
     unsigned long min = INT64_MAX;
     char maxc, minc;
-    for (std::pair<char, unsigned long> element : elements) {
+    for (std::pair<const char, unsigned long> const& element : elements) {
         if (element.second > max) { max = element.second; maxc = element.first; }
         if (element.second < min) { min = element.second; minc = element.first; }
     }
@@ -168,13 +174,114 @@ unsigned long countDiff (Problem const& prob) {
     return max - min;
 }
 
+/// The polymer as a linear recurrence on the counts of only those pairs that can ever appear.
+struct PairRecurrence {
+    /// The pairs that can appear, in the order used by the state vector.
+    std::vector<Pair> pairs;
+    /// How each step changes the pair counts.
+    LinearRecurrence recurrence;
+    /// The starting pair counts.
+    LinearRecurrence::State start;
+};
+
+/// \brief Expresses a problem as a linear recurrence on pair counts.
+/// Each pair AB with rule AB -> C becomes one AC and one CB.  A pair with no rule stays as it is.
+/// \param[in] prob The problem.
+/// \return A recurrence over the pairs reachable from those in the starting polymer.
+PairRecurrence makeRecurrence (Problem const& prob) {
+    std::vector<Pair> pairs;
+    std::unordered_map<Pair, std::size_t> indices;
+    std::deque<Pair> toVisit;
+    auto discover = [&] (Pair const& pair) {
+        if (indices.find (pair) == indices.end ()) {
+            indices.insert ({pair, pairs.size ()});
+            pairs.push_back (pair);
+            toVisit.push_back (pair);
+        }
+    };
+    for (std::pair<const Pair, unsigned long> const& count : prob.counts) {
+        discover (count.first);
+    }
+    while (!toVisit.empty ()) {
+        Pair current = toVisit.front ();
+        toVisit.pop_front ();
+        auto rule = prob.rules.find (current);
+        if (rule != prob.rules.end ()) {
+            discover ({current.first, rule->second});
+            discover ({rule->second, current.second});
+        }
+    }
+
+    PairRecurrence result {pairs, LinearRecurrence (pairs.size ()), LinearRecurrence::State (pairs.size (), 0ULL)};
+    for (std::size_t index {0U}; index < pairs.size (); ++index) {
+        auto rule = prob.rules.find (pairs[index]);
+        if (rule == prob.rules.end ()) {
+            result.recurrence.addTransition (index, index);
+        }
+        else {
+            result.recurrence.addTransition (index, indices.at ({pairs[index].first, rule->second}));
+            result.recurrence.addTransition (index, indices.at ({rule->second, pairs[index].second}));
+        }
+    }
+    for (std::pair<const Pair, unsigned long> const& count : prob.counts) {
+        result.start[indices.at (count.first)] = count.second;
+    }
+    return result;
+}
+
+/// \brief Counts how many times each letter occurs in a polymer.
+/// Every letter is the first of exactly one pair, except the last one, which never changes.
+/// \param[in] pairs The pairs in the order of the state vector.
+/// \param[in] counts How many times each pair occurs.
+/// \param[in] lastLetter The last letter of the polymer.
+/// \param[in] modulus What to reduce counts modulo, or 0 for none.
+/// \return How many times each character occurs, indexed by character.
+std::array<unsigned long long, 256> countElements (std::vector<Pair> const& pairs, LinearRecurrence::State const& counts, char lastLetter, unsigned long long modulus) {
+    std::array<unsigned long long, 256> elements {0ULL};
+    for (std::size_t index {0U}; index < pairs.size (); ++index) {
+        unsigned long long& element = elements[(unsigned char)pairs[index].first];
+        element = modulus == 0ULL ? element + counts[index] : (element + counts[index]) % modulus;
+    }
+    unsigned long long& last = elements[(unsigned char)lastLetter];
+    last = modulus == 0ULL ? last + 1ULL : (last + 1ULL) % modulus;
+    return elements;
+}
+
+/// \brief Finds the difference between the number of times the most frequent and least frequent letter appear.
+/// \param[in] elements How many times each character occurs.
+/// \return The difference, among characters that occur at all.
+unsigned long long countDiff (std::array<unsigned long long, 256> const& elements) {
+    unsigned long long max {0ULL};
+    unsigned long long min {std::numeric_limits<unsigned long long>::max ()};
+    for (unsigned long long count : elements) {
+        if (count == 0ULL) { continue; }
+        max = std::max (max, count);
+        min = std::min (min, count);
+    }
+    return max - min;
+}
+
 /// \brief Runs the prorgram.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv Optionally a (possibly enormous) number of steps, and a modulus to count letters modulo.
 /// \return Always 0.
-int main () {
+int main (int argc, char* argv[]) {
     Problem original = getInput ();
-    Problem after10 = iterate (original, 10U);
-    std::cout << countDiff (after10) << "\n";
-    Problem after40 = iterate (after10, 30U);
-    std::cout << countDiff (after40) << "\n";
+    PairRecurrence polymer = makeRecurrence (original);
+    LinearRecurrence::State after10 = polymer.recurrence.advance (polymer.start, 10U);
+    std::cout << countDiff (countElements (polymer.pairs, after10, original.lastLetter, 0ULL)) << "\n";
+    LinearRecurrence::State after40 = polymer.recurrence.advance (after10, 30U);
+    std::cout << countDiff (countElements (polymer.pairs, after40, original.lastLetter, 0ULL)) << "\n";
+
+    if (argc > 1) {
+        unsigned long long steps {std::stoull (argv[1])};
+        unsigned long long modulus {argc > 2 ? std::stoull (argv[2]) : 0ULL};
+        std::array<unsigned long long, 256> elements = countElements (polymer.pairs, polymer.recurrence.advance (polymer.start, steps, modulus), original.lastLetter, modulus);
+        for (std::size_t letter {0U}; letter < elements.size (); ++letter) {
+            if (elements[letter] != 0ULL) {
+                std::cout << (char)letter << ": " << elements[letter] << "\n";
+            }
+        }
+    }
     return 0;
-}
\ No newline at end of file
+}
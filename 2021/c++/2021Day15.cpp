@@ -3,10 +3,13 @@
 /// \brief My solution to https://adventofcode.com/2021/day/15.
 
 #include <iostream>
-#include <unordered_map>
 #include <string>
 #include <vector>
-#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
 
 #include "utilities.hpp"
 
@@ -17,28 +20,6 @@ using Risk = unsigned int;
 template<typename T>
 using Grid = std::vector<std::vector<T>>;
 
-/// A sequence of coordinates passed through.
-using Path = std::vector<Coordinate>;
-
-/// A coordinate with information about itself.
-struct CoordinatePlus {
-    /// \brief Constructs one.
-    /// \param[in] c The coordinate.
-    CoordinatePlus (Coordinate c) 
-        : coord {c}, cheapestPath {}, riskToGetHere {0}, estimatedRiskToGoal {0} {
-    }
-    /// The coordinate.
-    Coordinate coord;
-    /// The cheapest path we have found so far to the coordinate.
-    Path cheapestPath;
-    /// Total risk encountered along the cheapest path.
-    Risk riskToGetHere;
-    /// A low-ball estimate of how much further risk might be entailed in reaching the goal from here.
-    Risk estimatedRiskToGoal;
-
-    inline Risk getRisk () const { return riskToGetHere + estimatedRiskToGoal; }
-};
-
 /// The largest legal risk value.
 constexpr Risk MAX_RISK = 9U;
 /// The smallest legal risk value.
@@ -60,119 +41,97 @@ Grid<Risk> getInput () {
     return problem;
 }
 
-/// \brief Computes the heuristic cost of reaching the goal from a coordinate.
-/// \param[in] current The coordinate you are at.
-/// \param[in] goal The coordinate you'd like to be at.
-/// \return The minimum possible risk you could incur going from here to there.
-Risk heuristicCost (Coordinate const& current, Coordinate const& goal) {
-    Risk manhattan = std::abs (current.row - goal.row) + std::abs (current.col - goal.col);
-    return manhattan * MIN_RISK;
-}
-
-/// A comparator allowing us to create a priority queue ordered by total estimated risk.
-class CoordinatePlusComparator {
+/// A grid of risks that looks like the original tiled factor x factor times, with each tile's risks
+///   raised by its distance from the top-left tile.  Expanded risks are computed on the fly instead of stored.
+class TiledRiskMap {
 public:
-    /// \brief Compares two coordinate-plus-es.
-    /// \param[in] x A coordinate-plus.
-    /// \param[in] y Another coordinate-plus.
-    /// \return True if x should have lower priority (higher total risk) than y.
-    inline bool operator() (CoordinatePlus const& x, CoordinatePlus const& y) const {
-        return x.getRisk () > y.getRisk ();
+    /// \brief Constructs a tiled map.
+    /// \param[in] orig The original grid.
+    /// \param[in] factor How many times to repeat it in each direction.
+    TiledRiskMap (Grid<Risk> const& orig, unsigned int factor)
+        : m_tileRows (orig.size ()), m_tileCols (orig.at (0).size ()), m_factor (factor), m_risks {} {
+        for (std::vector<Risk> const& row : orig) {
+            m_risks.insert (m_risks.end (), row.begin (), row.end ());
+        }
     }
-};
-
-/// \brief Uses A* search to find the lowest risk path from upper-left to lower-right.
-/// \param[in] problem The grid of risks.
-/// \return A coordinate-plus containing the path and its risk level.
-CoordinatePlus findCheapestPath (Grid<Risk> const& problem) {
-    Coordinate goal {(int)problem.size () - 1, (int)problem.at (0).size () - 1};
-    CoordinatePlusComparator comp {};
-
-    std::vector<CoordinatePlus> open;
-    std::unordered_map<Coordinate, Risk> costs;
-    
-    CoordinatePlus start {{0, 0}};
-    start.cheapestPath.push_back ({0, 0});
-    start.estimatedRiskToGoal = heuristicCost (start.coord, goal);
-    open.push_back (start);
-    costs.insert (std::make_pair (start.coord, start.getRisk ()));
-    
-    while (!open.empty ()) {
-        std::pop_heap (open.begin (), open.end (), comp);
-        CoordinatePlus current {open.back ()};
-        open.pop_back ();
 
-        if (current.coord == goal) {
-            return current;
-        }
+    unsigned int rows () const { return m_tileRows * m_factor; }
+    unsigned int cols () const { return m_tileCols * m_factor; }
+
+    /// \brief Gets the risk of entering a location.
+    /// \param[in] row The row.
+    /// \param[in] col The column.
+    /// \return The risk, wrapped from MAX_RISK back around to MIN_RISK.
+    Risk at (unsigned int row, unsigned int col) const {
+        Risk base = m_risks[(row % m_tileRows) * m_tileCols + col % m_tileCols];
+        unsigned int additions = row / m_tileRows + col / m_tileCols;
+        return (base - MIN_RISK + additions) % (MAX_RISK - MIN_RISK + 1) + MIN_RISK;
+    }
 
-        if (current.getRisk () > costs.at (current.coord)) {
-            continue; // already found a cheaper route here
-        }
+private:
+    unsigned int m_tileRows;
+    unsigned int m_tileCols;
+    unsigned int m_factor;
+    std::vector<unsigned char> m_risks;
+};
 
-        std::vector<Coordinate> neighbors;
-        if (current.coord.row > 0) {
-            neighbors.push_back ({current.coord.row - 1, current.coord.col});
-        }
-        if (current.coord.row < (int)problem.size () - 1) {
-            neighbors.push_back ({current.coord.row + 1, current.coord.col});
-        }
-        if (current.coord.col > 0) {
-            neighbors.push_back ({current.coord.row, current.coord.col - 1});
-        }
-        if (current.coord.col < (int)problem.at (0).size () - 1) {
-            neighbors.push_back ({current.coord.row, current.coord.col + 1});
+/// \brief Uses Dijkstra's algorithm with a bucket queue (Dial's algorithm) to find the lowest risk
+///   from upper-left to lower-right.
+/// Every step costs between MIN_RISK and MAX_RISK, so only MAX_RISK + 1 distinct tentative risks
+///   can be pending at once, and a ring of that many buckets replaces the heap.
+/// \param[in] map The risks.
+/// \return The lowest risk to the goal.
+Risk findCheapestRisk (TiledRiskMap const& map) {
+    const unsigned int ROWS = map.rows ();
+    const unsigned int COLS = map.cols ();
+    const std::uint32_t UNREACHED = std::numeric_limits<std::uint32_t>::max ();
+    const std::uint32_t GOAL = ROWS * COLS - 1;
+    std::vector<std::uint32_t> risks (ROWS * COLS, UNREACHED);
+    std::array<std::vector<std::uint32_t>, MAX_RISK + 1> buckets;
+
+    risks[0] = 0U;
+    buckets[0].push_back (0U);
+    std::size_t pending = 1U;
+    for (std::uint32_t risk {0U}; pending > 0U; ++risk) {
+        std::vector<std::uint32_t>& bucket = buckets[risk % buckets.size ()];
+        // Entries added while processing this bucket are for larger risks, so this loop cannot grow it.
+        for (std::size_t index {0U}; index < bucket.size (); ++index) {
+            std::uint32_t cell = bucket[index];
+            if (risks[cell] != risk) { continue; }
+            if (cell == GOAL) { return risk; }
+            unsigned int row = cell / COLS;
+            unsigned int col = cell % COLS;
+            auto relax = [&] (unsigned int nextRow, unsigned int nextCol) {
+                std::uint32_t next = nextRow * COLS + nextCol;
+                std::uint32_t nextRisk = risk + map.at (nextRow, nextCol);
+                if (nextRisk < risks[next]) {
+                    risks[next] = nextRisk;
+                    buckets[nextRisk % buckets.size ()].push_back (next);
+                    ++pending;
+                }
+            };
+            if (row > 0U) { relax (row - 1, col); }
+            if (row + 1U < ROWS) { relax (row + 1, col); }
+            if (col > 0U) { relax (row, col - 1); }
+            if (col + 1U < COLS) { relax (row, col + 1); }
         }
-        for (Coordinate const& n : neighbors) {
-            CoordinatePlus next {n};
-            next.cheapestPath = current.cheapestPath;
-            next.cheapestPath.push_back (n);
-            next.riskToGetHere = current.riskToGetHere + problem.at (n.row).at (n.col);
-            next.estimatedRiskToGoal = heuristicCost (next.coord, goal);
-            if (costs.find (n) == costs.end () || costs.at (n) > next.getRisk ()) {
-                open.push_back (next);
-                std::push_heap (open.begin (), open.end (), comp);
-                costs[n] = next.getRisk ();
-            }
-        }
-
+        pending -= bucket.size ();
+        bucket.clear ();
     }
-    
-    throw std::runtime_error ("No path found.");
-}
 
-/// \brief Duplicates a problem to the left and right.
-/// \param[in] orig The original problem.
-/// \param[in] factor How much larger to make it.
-/// \return An expanded version of the problem.
-Grid<Risk> expandProblem (Grid<Risk> const& orig, unsigned int factor) {
-    const unsigned int ROWS = orig.size ();
-    const unsigned int COLS = orig.at (0).size ();
-    Grid<Risk> revised;
-    for (unsigned int row {0U}; row < ROWS * factor; ++row) {
-        std::vector<Risk> line;
-        for (unsigned int col {0U}; col < COLS * factor; ++col) {
-            unsigned int additions = row / ROWS + col / COLS;
-            Risk value = orig.at (row % ROWS).at (col % COLS);
-            for(unsigned int slow {0U}; slow < additions; ++slow) {
-                ++value;
-                if (value > MAX_RISK) { value = MIN_RISK; }
-            }
-            line.push_back (value);
-        }
-        revised.push_back (line);
-    }
-    return revised;
+    throw std::runtime_error ("No path found.");
 }
 
 /// \brief Runs the prorgram.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The command-line arguments; an optional extra tiling factor to solve.
 /// \return Always 0.
-int main () {
+int main (int argc, char* argv[]) {
     Grid<Risk> problem = getInput ();
-    CoordinatePlus answer1 = findCheapestPath (problem);
-    std::cout << answer1.riskToGetHere << "\n";
-    Grid<Risk> revised = expandProblem (problem, 5U);
-    CoordinatePlus answer2 = findCheapestPath (revised);
-    std::cout << answer2.riskToGetHere << "\n";
+    std::cout << findCheapestRisk (TiledRiskMap (problem, 1U)) << "\n";
+    std::cout << findCheapestRisk (TiledRiskMap (problem, 5U)) << "\n";
+    if (argc > 1) {
+        std::cout << findCheapestRisk (TiledRiskMap (problem, atoi (argv[1]))) << "\n";
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -5,24 +5,18 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <deque>
 #include <cassert>
-#include <memory>
-#include <climits>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
 
 #include "utilities.hpp"
 
-/// A stream of bits that can be encoded by pushing onto the back, decoded by popping from the front.
-using Bits = std::deque<bool>;
-
 /// The number of bits used to store a version.
 constexpr unsigned int VERSION_WIDTH = 3U;
 /// The number of bits used to store a typeID.
 constexpr unsigned int TYPEID_WIDTH = 3U;
-/// The largest possible verison value.
-constexpr unsigned int MAX_VERSION = 1U << VERSION_WIDTH;
-/// The largest possible typeID value.
-constexpr unsigned int MAX_TYPEID = 1U << TYPEID_WIDTH;
 /// The number of data bits in each chunk of a literal value.
 constexpr unsigned int LITERAL_CHUNK_WIDTH = 4U;
 /// The number of bits used to store a length of all subpackets combined.
@@ -47,277 +41,287 @@ constexpr unsigned int TYPE_LESSER = 6U;
 /// An operator packet that checks whether or not two subpackets are equal.
 constexpr unsigned int TYPE_EQUAL = 7U;
 
-/// \brief Extracts some number of bits from a bit stream and interprets them as an unsigned number.
-/// \param[inout] bits The bit stream.
-/// \param[in] length The number of bits to extract.
-/// \return The interpretation of those bits.
-/// \post That many bits have been extracted from the stream.
-unsigned int parseNumber (Bits & bits, unsigned int length) {
-    unsigned int value = 0U;
-    for (unsigned int count {0U}; count < length; ++count) {
-        value <<= 1;
-        value += bits.front ();
-        bits.pop_front ();
+/// A transmission packed 64 bits to a word, most significant bit first.
+struct PackedBits {
+    /// The bits, with one extra zero word on the end so reads never run off the array.
+    std::vector<std::uint64_t> words;
+    /// The number of meaningful bits.
+    std::size_t size;
+};
+
+/// \brief Converts a hexadecimal transmission to packed bits.
+/// \param[in] hex The transmission.
+/// \return The same bits, packed.
+PackedBits packHex (std::string const& hex) {
+    constexpr unsigned int HEXITS_PER_WORD = 16U;
+    PackedBits bits {std::vector<std::uint64_t> (hex.size () / HEXITS_PER_WORD + 2U, 0ULL), hex.size () * 4U};
+    for (std::size_t index {0U}; index < hex.size (); ++index) {
+        char c = hex[index];
+        std::uint64_t hexit;
+        if (c >= '0' && c <= '9') { hexit = c - '0'; }
+        else if (c >= 'A' && c <= 'F') { hexit = c - 'A' + 10; }
+        else if (c >= 'a' && c <= 'f') { hexit = c - 'a' + 10; }
+        else { throw std::runtime_error ("Character " + std::to_string (c) + " does not belong in a hexidecimal value."); }
+        bits.words[index / HEXITS_PER_WORD] |= hexit << (60U - 4U * (index % HEXITS_PER_WORD));
     }
-    return value;
+    return bits;
 }
 
-
-/// \brief A packet received in the Buoyancy Interchange Transmission System.
-class Packet {
+/// Reads fields from packed bits using shifts and masks on whole words.
+class BitReader {
 public:
-    /// \brief Constructs a packet.
-    /// \param[in] version The version number of the packet, which must be a number 0-8.
-    /// \param[in] typeID The type of the packet, which must be a number 0-8.
-    /// \return The values have been stored.
-    Packet (unsigned int version, unsigned int typeID)
-        : m_version (version), m_typeID (typeID) {
-        if (version > MAX_VERSION) { throw std::runtime_error ("Version " + std::to_string (version) + " would not fit in " + std::to_string (VERSION_WIDTH) + " bits."); }
-        if (typeID > MAX_TYPEID) { throw std::runtime_error ("TypeID " + std::to_string (typeID) + " would not fit in " + std::to_string (TYPEID_WIDTH) + " bits."); }
+    /// \brief Constructs a reader at the start of some bits.
+    /// \param[in] bits The bits, which must outlive the reader.
+    BitReader (PackedBits const& bits) : m_bits (bits), m_position {0U} {}
+
+    /// \brief Extracts some number of bits and interprets them as an unsigned number.
+    /// \param[in] width The number of bits to extract, 1-64.
+    /// \return The interpretation of those bits.
+    std::uint64_t read (unsigned int width) {
+        assert (width > 0U && width <= 64U);
+        if (m_position + width > m_bits.size) { throw std::runtime_error ("Read past the end of the transmission."); }
+        std::size_t word = m_position / 64U;
+        unsigned int offset = m_position % 64U;
+        std::uint64_t high = m_bits.words[word] << offset;
+        if (offset + width > 64U) {
+            high |= m_bits.words[word + 1U] >> (64U - offset);
+        }
+        m_position += width;
+        return high >> (64U - width);
     }
 
-    /// \brief Virtual destructor, just because I want to derive other classes.
-    virtual ~Packet () {}
-
-    /// \brief Adds the version numbers of this and all subpackets.
-    /// \return The sum of all version numbers that appears in this packet.
-    /// \note Any derived class that has subpackets will need to override this.
-    virtual long addVersionNumbers () const { return m_version; }
-
-    /// \brief Evaluates the expression contained within this packet.
-    /// \return The value of the expression.
-    virtual unsigned long long evaluate () const = 0;
-
-    /// \brief Gets the type of this packet.
-    /// \return The tyep of this packet.
-    inline unsigned int getTypeID () const { return m_typeID; }
+    std::size_t position () const { return m_position; }
 
 private:
-    /// The version of this packet.
-    const unsigned int m_version;
-    /// The type of this packet.
-    const unsigned int m_typeID;
+    PackedBits const& m_bits;
+    std::size_t m_position;
 };
 
+/// \brief Parses one packet (and everything inside it) without recursion, reporting to a sink.
+/// Operators are reported to sink.open (version, typeID) before their subpackets and to
+///   sink.close (version, typeID, subpacketCount) after them, and literals to sink.literal (version, value),
+///   so the sink sees packets in post-order.
+/// \param[inout] reader A reader positioned at the start of a packet.
+/// \param[inout] sink The thing being told about packets.
+template<typename Sink>
+void parsePacket (BitReader & reader, Sink & sink) {
+    /// An operator packet whose subpackets are still being read.
+    struct Frame {
+        unsigned int version;
+        unsigned int typeID;
+        bool byLength;
+        /// The bit position where the subpackets end, or how many of them there are.
+        std::size_t limit;
+        std::uint32_t children;
+    };
+    std::vector<Frame> open;
+    do {
+        unsigned int version = reader.read (VERSION_WIDTH);
+        unsigned int typeID = reader.read (TYPEID_WIDTH);
+        if (typeID == TYPE_LITERAL) {
+            unsigned long long value {0ULL};
+            bool more {true};
+            while (more) {
+                more = reader.read (1U);
+                value = (value << LITERAL_CHUNK_WIDTH) | reader.read (LITERAL_CHUNK_WIDTH);
+            }
+            sink.literal (version, value);
+            if (!open.empty ()) { ++open.back ().children; }
+        }
+        else {
+            sink.open (version, typeID);
+            if (reader.read (1U) == 0U) {
+                std::size_t length = reader.read (LENGTH_OF_SUBPACKETS_WIDTH);
+                open.push_back ({version, typeID, true, reader.position () + length, 0U});
+            }
+            else {
+                open.push_back ({version, typeID, false, reader.read (NUMBER_OF_SUBPACKETS_WIDTH), 0U});
+            }
+        }
+        while (!open.empty () && (open.back ().byLength ? reader.position () >= open.back ().limit : open.back ().children == open.back ().limit)) {
+            Frame finished = open.back ();
+            open.pop_back ();
+            sink.close (finished.version, finished.typeID, finished.children);
+            if (!open.empty ()) { ++open.back ().children; }
+        }
+    } while (!open.empty ());
+}
 
-// Forward declaration -- see definition below for documentation.
-std::unique_ptr<Packet> parse (Bits & bits);
-
-
-/// \brief A packet that represents a single literal value.
-class LiteralPacket : public Packet {
-public:
-    /// \brief Constructs a literal packet.
-    /// \param[in] version The new packet's version.
-    /// \param[in] typeID The new packet's type.
-    /// \param[inout] bits A bit stream from which more information can be extracted.
-    /// \post The literal value has been extracted from the bit stream and all fields set.
-    LiteralPacket (unsigned int version, unsigned int typeID, Bits & bits) 
-        : Packet (version, typeID), m_value {parseValue (bits)} {
-    }
-    /// \brief Destructor does not need to do anything.
-    virtual ~LiteralPacket () {}
-
-    /// \brief Evaluates this packet.
-    /// \return The literal value stored here.
-    virtual unsigned long long evaluate () const {
-        return m_value;
-    }
-
-private:
-    /// \brief Parses a literal value from a bit stream.
-    /// \param[inout] bits The bit stream.
-    /// \return The value.
-    /// \post The value will have been extracted from the bit stream.
-    static unsigned long long parseValue (Bits & bits) {
-        bool finished = false;
-        unsigned long long value = 0ULL;
-        while (!finished) {
-            finished = !bits.front ();
-            bits.pop_front ();
-            unsigned int nextPart = parseNumber (bits, LITERAL_CHUNK_WIDTH);
-            value <<= LITERAL_CHUNK_WIDTH;
-            value += nextPart;
+/// \brief Applies an operator to one more operand.
+/// \param[in] typeID The operator.
+/// \param[in] soFar The result of applying it to the operands before this one.
+/// \param[in] position How many operands came before this one.
+/// \param[in] operand The new operand.
+/// \return The result of applying the operator to all operands so far.
+unsigned long long combine (unsigned int typeID, unsigned long long soFar, std::uint32_t position, unsigned long long operand) {
+    if (position == 0U) { return operand; }
+    switch (typeID) {
+        case TYPE_SUM: return soFar + operand;
+        case TYPE_PRODUCT: return soFar * operand;
+        case TYPE_MINIMUM: return std::min (soFar, operand);
+        case TYPE_MAXIMUM: return std::max (soFar, operand);
+        case TYPE_GREATER:
+        case TYPE_LESSER:
+        case TYPE_EQUAL: {
+            if (position != 1U) { throw std::runtime_error ("A comparison packet did not have 2 subpackets."); }
+            if (typeID == TYPE_GREATER) { return soFar > operand; }
+            if (typeID == TYPE_LESSER) { return soFar < operand; }
+            return soFar == operand;
         }
-        return value;
+        default: throw std::runtime_error (std::to_string (typeID) + " is not an operator type.");
     }
+}
 
-private:
-    /// The literal value stored in this packet.
-    const unsigned long long m_value;
-};
+/// \brief Checks that an operator got a sensible number of operands.
+/// \param[in] typeID The operator.
+/// \param[in] count The number of operands.
+void checkOperandCount (unsigned int typeID, std::uint32_t count) {
+    if ((typeID == TYPE_MINIMUM || typeID == TYPE_MAXIMUM) && count == 0U) { throw std::runtime_error ("A minimum or maximum packet with no subpackets was found."); }
+    if ((typeID == TYPE_GREATER || typeID == TYPE_LESSER || typeID == TYPE_EQUAL) && count != 2U) { throw std::runtime_error ("A comparison packet did not have 2 subpackets."); }
+}
 
+/// \brief Gets the value of an operator with no operands.
+/// \param[in] typeID The operator.
+/// \return 0 for sums, 1 for products.
+unsigned long long emptyValue (unsigned int typeID) {
+    return typeID == TYPE_PRODUCT ? 1ULL : 0ULL;
+}
 
+/// One packet in a flat, post-order array: every packet comes right after its last subpacket.
+struct PacketNode {
+    std::uint8_t version;
+    std::uint8_t typeID;
+    /// The number of direct subpackets.
+    std::uint32_t children;
+    /// The literal value, if this is a literal.
+    unsigned long long value;
+};
 
+/// A sink for parsePacket that appends packets to an arena.
+struct ArenaBuilder {
+    std::vector<PacketNode> nodes;
 
+    void open (unsigned int, unsigned int) {}
 
-/// \brief A packet that represents an operator.
-/// \note We could derive 7 more classes from this, but that seems like overkill for now.
-class OperatorPacket : public Packet {
-public:
-    /// \brief Constructs an operator packet.
-    /// \param[in] version The version of the new packet.
-    /// \param[in] typeID The type of the new packet.
-    /// \param[inout] bits A bit stream from which the next packet can be extracted.
-    /// \post All subpackets have been extracted from the bit stream, all fields set correctly.
-    OperatorPacket (unsigned int version, unsigned int typeID, Bits & bits) 
-        : Packet (version, typeID), m_subPackets (parseSubpackets (bits)) {
+    void literal (unsigned int version, unsigned long long value) {
+        nodes.push_back ({(std::uint8_t)version, (std::uint8_t)TYPE_LITERAL, 0U, value});
     }
 
-    /// \brief Destructor can just let the member destructor do its thing.
-    virtual ~OperatorPacket () {}
-
-    /// \brief Adds the version numbers of this packet and all of its subpackets.
-    /// \return The sum of this packet's version numbers and its subpacket's version numbers (with all of their descendants).
-    virtual long addVersionNumbers () const {
-        long result = Packet::addVersionNumbers ();
-        for (std::unique_ptr<const Packet> const& sub : m_subPackets) {
-            result += sub->addVersionNumbers ();
-        }
-        return result;
+    void close (unsigned int version, unsigned int typeID, std::uint32_t children) {
+        checkOperandCount (typeID, children);
+        nodes.push_back ({(std::uint8_t)version, (std::uint8_t)typeID, children, 0ULL});
     }
+};
 
-    /// \brief Evaluates the expression this packet represents.
-    /// \return The result of applying this operator to its operands.
-    virtual unsigned long long evaluate () const {
-        switch (getTypeID ()) {
-            case TYPE_SUM: {
-                unsigned long long sum {0ULL};
-                for (std::unique_ptr<const Packet> const& sub : m_subPackets) {
-                    sum += sub->evaluate ();
-                }
-                return sum;
-            }
-            case TYPE_PRODUCT: {
-                unsigned long long product {1ULL};
-                for (std::unique_ptr<const Packet> const& sub : m_subPackets) {
-                    product *= sub->evaluate ();
-                }
-                return product;
-            }
-            case TYPE_MINIMUM: {
-                if (m_subPackets.size () == 0U) { throw std::runtime_error ("A minimum operator packet with no subpackets was found."); }
-                unsigned long long min {ULLONG_MAX};
-                for (std::unique_ptr<const Packet> const& sub : m_subPackets) {
-                    unsigned long long curr = sub->evaluate ();
-                    if (curr < min) {
-                        min = curr;
-                    }
-                }
-                return min;
-            }
-            case TYPE_MAXIMUM: {
-                if (m_subPackets.size () == 0U) { throw std::runtime_error ("A maximum operator packet with no subpackets was found."); }
-                unsigned long long max {0ULL};
-                for (std::unique_ptr<const Packet> const& sub : m_subPackets) {
-                    unsigned long long curr = sub->evaluate ();
-                    if (curr > max) {
-                        max = curr;
-                    }
-                }
-                return max;
-            }
-            case TYPE_GREATER: {
-                if (m_subPackets.size () != 2) { throw std::runtime_error ("A greater-than packet did not have 2 subpackets."); }
-                return m_subPackets.at (0)->evaluate () > m_subPackets.at (1)->evaluate ();
-            }
-            case TYPE_LESSER: {
-                if (m_subPackets.size () != 2) { throw std::runtime_error ("A less-than packet did not have 2 subpackets."); }
-                return m_subPackets.at (0)->evaluate () < m_subPackets.at (1)->evaluate ();
-            }
-            case TYPE_EQUAL: {
-                if (m_subPackets.size () != 2) { throw std::runtime_error ("An equal-to packet did not have 2 subpackets."); }
-                return m_subPackets.at (0)->evaluate () == m_subPackets.at (1)->evaluate ();
-            }
-            default: {
-                throw std::runtime_error (std::to_string (getTypeID ()) + " is not an operator type.");
-            }
-        }
-    }
-    
-private:
-    /// \brief Parses a bit stream, extracting subpackets.
-    /// \param[inout] bits A bit stream for an operator packet from which version and type ID have already been extracted.
-    /// \return A vector of subpackets.
-    /// \post Information about the subpackets has been extracted from the bit stream.
-    static std::vector<std::unique_ptr<const Packet>> parseSubpackets (Bits & bits) {
-        std::vector<std::unique_ptr<const Packet>> subpackets;
-        bool lengthTypeID = bits.front ();
-        bits.pop_front ();
-        if (lengthTypeID == false) {
-            unsigned int totalLengthOfSubpackets = parseNumber (bits, LENGTH_OF_SUBPACKETS_WIDTH);
-            unsigned int targetBits = bits.size () - totalLengthOfSubpackets;
-            while (bits.size () != targetBits) {
-                subpackets.push_back (parse (bits));
-            }
+/// \brief Adds the version numbers of every packet in an arena.
+/// \param[in] nodes The packets.
+/// \return The sum of all version numbers.
+long addVersionNumbers (std::vector<PacketNode> const& nodes) {
+    long result {0L};
+    for (PacketNode const& node : nodes) { result += node.version; }
+    return result;
+}
+
+/// \brief Evaluates the expression in an arena with a stack of operand values.
+/// \param[in] nodes The packets, in post-order.
+/// \return The value of the last (outermost) packet.
+unsigned long long evaluate (std::vector<PacketNode> const& nodes) {
+    std::vector<unsigned long long> values;
+    for (PacketNode const& node : nodes) {
+        if (node.typeID == TYPE_LITERAL) {
+            values.push_back (node.value);
+            continue;
         }
-        else {
-            unsigned int numberOfSubpackets = parseNumber (bits, NUMBER_OF_SUBPACKETS_WIDTH);
-            for (unsigned int count {0U}; count < numberOfSubpackets; ++count) {
-                subpackets.push_back (parse (bits));
-            }
+        std::size_t first = values.size () - node.children;
+        unsigned long long result {emptyValue (node.typeID)};
+        for (std::uint32_t index {0U}; index < node.children; ++index) {
+            result = combine (node.typeID, result, index, values[first + index]);
         }
-        return subpackets;
+        values.resize (first);
+        values.push_back (result);
     }
+    assert (values.size () == 1U);
+    return values.back ();
+}
 
-private:
-    /// A vector of subpackets.
-    const std::vector<std::unique_ptr<const Packet>> m_subPackets;
-};
-
-
-
-/// \brief Parses a bit stream into a packet.
-/// \param[inout] bits The bit stream.
-/// \return A packet.
-/// \post The relevant bits have been extracted from the bit stream.
-std::unique_ptr<Packet> parse (Bits & bits) {
-    unsigned int version = parseNumber (bits, VERSION_WIDTH);
-    unsigned int typeID = parseNumber (bits, TYPEID_WIDTH);
-    if (typeID == TYPE_LITERAL) {
-        return std::unique_ptr<Packet> (new LiteralPacket (version, typeID, bits));
+/// A sink for parsePacket that computes the answers as it goes, never holding more than one partial
+///   result per currently open operator.
+struct StreamingEvaluator {
+    struct Partial {
+        unsigned int typeID;
+        unsigned long long value;
+        std::uint32_t count;
+    };
+    std::vector<Partial> partials;
+    long versionSum {0L};
+    unsigned long long result {0ULL};
+
+    void open (unsigned int version, unsigned int typeID) {
+        versionSum += version;
+        partials.push_back ({typeID, emptyValue (typeID), 0U});
     }
-    else {
-        return std::unique_ptr<Packet> (new OperatorPacket (version, typeID, bits));
+
+    void literal (unsigned int version, unsigned long long value) {
+        versionSum += version;
+        fold (value);
     }
-}
 
-/// \brief Inserts a hexit into a bit stream.
-/// \param[out] bits The straem into which the hexit should be inserted.
-/// \param[in] num The hexit.
-/// \post Four bits representing the hexit have been inserted into the bit stream.
-void pushHex (Bits & bits, int num) {
-    bits.push_back (num / 8);
-    bits.push_back ((num % 8) / 4);
-    bits.push_back ((num % 4) / 2);
-    bits.push_back (num % 2);
-}
+    void close (unsigned int, unsigned int typeID, std::uint32_t children) {
+        checkOperandCount (typeID, children);
+        unsigned long long value = partials.back ().value;
+        partials.pop_back ();
+        fold (value);
+    }
 
-/// \brief Reads a hexadecimal value from standard input and converts it to a bit stream.
-Bits getInput () {
-    std::string line = read<std::string> ();
-    Bits result;
-    for (char c : line) {
-        if ( !( (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f') ) ) { throw std::runtime_error ("Character " + std::to_string (c) + " does not belong in a hexidecimal value."); }
-        if (std::isdigit (c)) {
-            pushHex (result, c - '0');
-        }
-        else if (std::islower (c)) {
-            pushHex (result, c - 'a' + 10);
-        }
-        else {
-            pushHex (result, c - 'A' + 10);
+    void fold (unsigned long long value) {
+        if (partials.empty ()) {
+            result = value;
+            return;
         }
+        Partial & top = partials.back ();
+        top.value = combine (top.typeID, top.value, top.count, value);
+        ++top.count;
     }
-    return result;
+};
+
+/// \brief Parses a transmission with the streaming evaluator, without building any tree.
+/// \param[in] bits The transmission.
+/// \return The sum of the version numbers and the value of the outermost packet.
+std::pair<long, unsigned long long> evaluateStreaming (PackedBits const& bits) {
+    BitReader reader (bits);
+    StreamingEvaluator streaming;
+    parsePacket (reader, streaming);
+    return {streaming.versionSum, streaming.result};
 }
 
 /// \brief Runs the prorgram.
-/// \return Always 0.
-int main () {
-    Bits bits = getInput ();
-    std::unique_ptr<Packet> packet = parse (bits);
-    std::cout << packet->addVersionNumbers () << "\n";
-    std::cout << packet->evaluate () << "\n";
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv Optionally --stream to evaluate as the bits are read instead of building the packet tree,
+///   or --verify to do both and check that they agree.
+/// \return 0, unless --verify found a disagreement.
+int main (int argc, char* argv[]) {
+    PackedBits bits = packHex (read<std::string> ());
+    std::string mode {argc > 1 ? argv[1] : ""};
+    if (mode == "--stream") {
+        std::pair<long, unsigned long long> answers = evaluateStreaming (bits);
+        std::cout << answers.first << "\n";
+        std::cout << answers.second << "\n";
+        return 0;
+    }
+    BitReader reader (bits);
+    ArenaBuilder arena;
+    parsePacket (reader, arena);
+    long versionSum = addVersionNumbers (arena.nodes);
+    unsigned long long value = evaluate (arena.nodes);
+    std::cout << versionSum << "\n";
+    std::cout << value << "\n";
+    if (mode == "--verify") {
+        std::pair<long, unsigned long long> answers = evaluateStreaming (bits);
+        if (answers.first != versionSum || answers.second != value) {
+            std::cout << "Streaming evaluator disagrees: " << answers.first << " " << answers.second << "\n";
+            return 1;
+        }
+        std::cout << "Streaming evaluator agrees\n";
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -2,32 +2,24 @@
 /// \author Chad Hogg
 /// \brief My solution to https://adventofcode.com/2021/day/19.
 
-// Key insight: If sensor A sees two beacons that are X distance from each other and sensor B sees two beacons that are X distance from each other,
-//   then those two beacons are likely to be the same beacons.
-// We can determine which ones in the pair match each other by looking for other pairs that involve one but not the other.
-
-// Second key insight: If those beacons are the same, there is an affine transformation from sensor B's view of the world to sensor A's,
-//   and we can find that transformation matrix by solving a system of linear equations.
-// Specifically, any beacon gives us three of the equations, with [x,y,z] being the original location, [x',y',z'] being location from sensor 0's perspective.
-//   x'   a b c d   x   ax + by + cz + d
-//   y'   e f g h   y   ex + fy + gz + h
-//   z' = i j k l * z = ix + jy + kz + l
-//   1    0 0 0 1   1   0  + 0  + 0  + 1
-//
-//   xa + yb + zc + 1d + 0e + 0f + 0g + 0h + 0i + 0j + 0k + 0l = x'
-//   0a + 0b + 0c + 0d + xe + yf + zg + 1h + 0i + 0j + 0k + 0l = y'
-//   0a + 0b + 0c + 0d + 0e + 0f + 0g + 0h + xi + yj + zk + 1l = z'
-// After solving the system of linear equations to find a, b, ... l we can apply it to all beacons and the sensor itself to find true coordinates.
+// Key insight: the squared distances from a beacon to the other beacons its scanner sees do not change when the scanner
+//   rotates or moves, so two scanners that see the same beacon see the same distances from it.
+// Sorted lists of those distances ("fingerprints") pair up beacons between overlapping scanners, and then one of the 24
+//   rotations plus the translation implied by a single pair carries one scanner's coordinates into the other's.
 
 
 #include <iostream>
+#include <array>
 #include <cstdio>
 #include <string>
 #include <cassert>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
-#include <cmath>
+#include <algorithm>
+#include <deque>
+#include <optional>
+#include <stdexcept>
 
 #include "utilities.hpp"
 
@@ -38,16 +30,6 @@ struct Vec3 {
     /// The three components of the vector.
     long m_x, m_y, m_z;
 
-    /// \brief Calculates the Euclidean distance between this point and another point.
-    /// \param[in] other The other point.
-    /// \return The Euclidean distance between myself and it.
-    double distance (Vec3 const& other) const {
-        long xDiff = m_x - other.m_x;
-        long yDiff = m_y - other.m_y;
-        long zDiff = m_z - other.m_z;
-        return sqrt (xDiff * xDiff + yDiff * yDiff + zDiff * zDiff);
-    }
-
     /// \brief Tests whether or not two vectors are identical.
     /// \param[in] other The other vector.
     /// \return True if this vector and the other vector are the same.
@@ -67,175 +49,9 @@ struct std::hash<Vec3> {
     }
 };
 
-/// \brief Inserts a vector into an output stream.
-/// \param[inout] out The stream.
-/// \param[in] vec The vector.
-/// \return The stream.
-std::ostream& operator<< (std::ostream & out, Vec3 const& vec) {
-    out << vec.m_x << "," << vec.m_y << "," << vec.m_z;
-    return out;
-}
-
-
-
-/// A system of linear equations, modeled as an augmented matrix.
-class SystemOfEquations {
-public:
-    using Row = std::vector<double>;
-    using Matrix = std::vector<Row>;
-
-    /// \brief Adds an equation to the system.
-    /// \param[in] row A vector of coefficient values.
-    /// \post This equation has been added to the system.
-    void addEquation (Row const& row) {
-        m_matrix.push_back (row);
-    }
-
-    /// \brief Attempts to solve the system of equations using Gauss-Jordan Elimination.
-    /// \post The equations are solved such that each has the value of one variable.
-    /// \return The values of each of the variables.
-    std::vector<double> solve () {
-        moveZeroesToBottom ();
-        triangularForm ();
-        if (hasAllZeroesRow ()) {
-            throw std::runtime_error ("There are an infinite number of solutions to the system of equations.");
-        }
-        else if(hasAlmostAllZeroesRow ()) {
-            throw std::runtime_error ("There is no solution to the system of equations.");
-        }
-        reduce ();
-        backSubstitute ();
-        std::vector<double> results;
-        for (Row const& row : m_matrix) {
-            results.push_back (row.back ());
-        }
-        return results;
-    }
-
-
-private:
-
-    inline static bool approxEqual (double x, double y) {
-        return std::abs (x - y) < 0.00001;
-    }
-
-    void swapRows (unsigned int rowIndexA, unsigned int rowIndexB) {
-        Row temp = m_matrix[rowIndexA];
-        m_matrix[rowIndexA] = m_matrix[rowIndexB];
-        m_matrix[rowIndexB] = temp;
-    }
-
-    unsigned int countLeadingZeroes (unsigned int rowIndex) const {
-        for (unsigned int index {0U}; index < m_matrix.at (rowIndex).size (); ++index) {
-            if (!approxEqual (m_matrix.at (rowIndex).at (index), 0.0f)) {
-                return index;
-            }
-        }
-        return m_matrix.at (rowIndex).size ();
-    }
-
-    void moveZeroesToBottom () {
-        for (int targetRow {(int)m_matrix.size () - 1}; targetRow > 0; --targetRow) {
-            unsigned int indexWithMostLeadingZeroes = targetRow;
-            for (int otherRow {targetRow - 1}; otherRow >= 0; --otherRow) {
-                if (countLeadingZeroes (otherRow) > countLeadingZeroes (indexWithMostLeadingZeroes)) {
-                    indexWithMostLeadingZeroes = otherRow;
-                }
-            }
-            swapRows (targetRow, indexWithMostLeadingZeroes);
-        }
-    }
-
-    void triangularForm () {
-        for (unsigned int killerRow {0U}; killerRow < m_matrix.size (); ++killerRow) {
-            for (unsigned int killedRow {killerRow + 1U}; killedRow < m_matrix.size (); ++killedRow) {
-                double factor = m_matrix.at (killedRow).at (killerRow) / m_matrix.at (killerRow).at (killerRow);
-                for (unsigned int col {0U}; col < m_matrix.at (0).size (); ++col) {
-                    m_matrix[killedRow][col] = m_matrix[killedRow][col] - factor * m_matrix[killerRow][col];
-                }
-            }
-            moveZeroesToBottom ();
-        }
-    }
-
-    bool hasAllZeroesRow () const {
-        for (unsigned int row {0U}; row < m_matrix.size (); ++row) {
-            if (countLeadingZeroes (row) == m_matrix.at (row).size ()) {
-                return true;
-            }
-        }
-        return false;
-    }
-
-    bool hasAlmostAllZeroesRow () const {
-        for (unsigned int row {0U}; row < m_matrix.size (); ++row) {
-            if (countLeadingZeroes (row) == m_matrix.at (row).size () - 1) {
-                return true;
-            }
-        }
-        return false;
-    }
-
-    void reduce () {
-        for (unsigned int row {0U}; row < m_matrix.size (); ++row) {
-            double factor = m_matrix.at (row).at (row);
-            for (unsigned int col {0U}; col < m_matrix.at (row).size (); ++col) {
-                m_matrix[row][col] /= factor;
-            }
-        }
-    }
-
-    void backSubstitute () {
-        for (int rowUsed {(int)m_matrix.size () - 1}; rowUsed >= 0; --rowUsed) {
-            for (int rowModified {rowUsed - 1}; rowModified >= 0; --rowModified) {
-                double factor = m_matrix.at (rowModified).at (rowUsed);
-                for (unsigned int col {0U}; col < m_matrix.at (0).size (); ++col) {
-                    m_matrix[rowModified][col] -= factor * m_matrix[rowUsed][col];
-                }
-            }
-        }
-    }
-
-    Matrix m_matrix;
-};
-
-
-
-/// A representation of an affine transformation in 3D space.
-class TransformationMatrix {
-public:
-
-    /// \brief Constructs a transformation matrix.
-    /// \param[in] coefficients The values to be stored in the matrix, in row order.
-    TransformationMatrix (std::vector<double> const& coefficients) {
-        assert (coefficients.size () == 12);
-        for (unsigned int row {0U}; row < m_matrix.size (); ++row) {
-            for (unsigned int col {0U}; col < m_matrix[row].size (); ++col) {
-                m_matrix[row][col] = coefficients.at (row * m_matrix[row].size () + col);
-            }
-        }
-    }
-
-    /// \brief Transforms a vector.
-    /// \param[in] input The input vector.  It is presumed to have a fourth component of 1.
-    /// \return The vector after being multiplied on the left by this matrix.
-    Vec3 multiply (Vec3 const& input) const {
-        Vec3 result;
-        result.m_x = lrint (m_matrix[0][0] * input.m_x + m_matrix[0][1] * input.m_y + m_matrix[0][2] * input.m_z + m_matrix[0][3]);
-        result.m_y = lrint (m_matrix[1][0] * input.m_x + m_matrix[1][1] * input.m_y + m_matrix[1][2] * input.m_z + m_matrix[1][3]);
-        result.m_z = lrint (m_matrix[2][0] * input.m_x + m_matrix[2][1] * input.m_y + m_matrix[2][2] * input.m_z + m_matrix[2][3]);
-        return result;
-    }
-
-private:
-    std::array<std::array<double, 4>, 3> m_matrix;
-};
-
-
 using Beacon = Vec3;
 using Index = unsigned int;
 using ScanID = unsigned int;
-using Distance = double;
 using IndexPair = std::pair<Index, Index>;
 
 
@@ -245,10 +61,6 @@ struct Scanner {
     ScanID m_id;
     /// A collection of the locations of its beacons.
     std::vector<Beacon> m_beacons;
-    /// A map from distances to pairs of beacons, for finding overlapping scanners.
-    std::unordered_map<Distance, IndexPair> m_distances;
-    /// The location of the scanner, relative to scanner 0.
-    Vec3 m_location;
 };
 
 
@@ -286,210 +98,282 @@ SomeScanners getInput () {
     if (workingOnScanner) {
         scanners.insert ({scanner.m_id, scanner});
     }
-
-    for (std::pair<const ScanID, Scanner> & current : scanners) {
-        for (Index index1 {0U}; index1 < current.second.m_beacons.size (); ++index1) {
-            for (Index index2 {index1 + 1U}; index2 < current.second.m_beacons.size (); ++index2) {
-                Distance distance = current.second.m_beacons.at (index1).distance (current.second.m_beacons.at (index2));
-                assert (current.second.m_distances.find (distance) == current.second.m_distances.end ());
-                current.second.m_distances.insert ({distance, {index1, index2}});
-            }
-        }
-    }
     return scanners;
 }
 
 
-/// \brief Finds the pairs of beacons in two scanners that have the same distance from each other.
-/// \param[in] done A scanner whose position and orientation are already fixed.
-/// \param[in] other Another scanner, whose position and orientation are not yet known.
-/// \return A vector of pairs in which the first element is a pair of beacon indexes in done and the seocnd is a pair of beacon indexes in other
-///   and the distance between the first pair equals the distance between the second pair. 
-std::vector<std::pair<IndexPair, IndexPair>> findSameDistanceBeacons (Scanner const& done, Scanner const& other) {
-    std::vector<std::pair<IndexPair, IndexPair>> beaconPairPairs;
-    for (std::pair<Distance, IndexPair> const& donePair : done.m_distances) {
-        auto iter = other.m_distances.find (donePair.first);
-        if (iter != other.m_distances.end ()) {
-            beaconPairPairs.push_back ({donePair.second, (*iter).second});
-        }
-    }
-    return beaconPairPairs;
+/// An exact squared distance, which unlike a Euclidean distance needs no rounding to compare.
+using SquaredDistance = long;
+/// A rotation, as a 3x3 matrix whose entries are all -1, 0, or 1.
+using Rotation = std::array<std::array<long, 3>, 3>;
+
+/// \brief Applies a rotation to a vector.
+/// \param[in] rotation The rotation.
+/// \param[in] vec The vector.
+/// \return The rotated vector.
+Vec3 rotate (Rotation const& rotation, Vec3 const& vec) {
+    return {rotation[0][0] * vec.m_x + rotation[0][1] * vec.m_y + rotation[0][2] * vec.m_z,
+            rotation[1][0] * vec.m_x + rotation[1][1] * vec.m_y + rotation[1][2] * vec.m_z,
+            rotation[2][0] * vec.m_x + rotation[2][1] * vec.m_y + rotation[2][2] * vec.m_z};
 }
 
-/// \brief Determines which beacon index in the other scanner matches a given index in the finished scanner.
-/// \param[in] doneIndex The beacon index within the finished scanner that we are trying to match.  It should be common to both pairs.
-/// \param[in] matchA One pair of same distance beacon pairs.
-/// \param[in] matchB Another pair of same distance beacon pairs.
-/// \return The index from the unfinished scanner that is common to both pairs. 
-Index findCommonIndex (Index doneIndex, std::pair<IndexPair, IndexPair> const& matchA, std::pair<IndexPair, IndexPair> const& matchB) {
-    assert (matchA.first.first == doneIndex || matchA.first.second == doneIndex);
-    assert (matchB.first.first == doneIndex || matchB.first.second == doneIndex);
-    IndexPair const& otherMatchA = matchA.second;
-    IndexPair const& otherMatchB = matchB.second;
-    // There should be one number that appears in both otherMatchA and otherMatchB, and we want to map doneIndex to it.
-    if (otherMatchA.first == otherMatchB.first || otherMatchA.first == otherMatchB.second) { return otherMatchA.first; }
-    else if (otherMatchA.second == otherMatchB.first || otherMatchA.second == otherMatchB.second) { return otherMatchA.second; }
-    else { throw std::runtime_error ("There was no number in common between " + to_string (otherMatchA) + " and " + to_string (otherMatchB)); }
+/// \brief Generates the 24 ways a scanner might be facing.
+/// \return Every signed permutation matrix with determinant 1.
+std::vector<Rotation> getAllRotations () {
+    std::vector<Rotation> rotations;
+    std::array<int, 3> axes {0, 1, 2};
+    do {
+        for (int signs {0}; signs < 8; ++signs) {
+            Rotation rotation {};
+            for (int row {0}; row < 3; ++row) {
+                rotation[row][axes[row]] = (signs & (1 << row)) ? -1 : 1;
+            }
+            long determinant = rotation[0][0] * (rotation[1][1] * rotation[2][2] - rotation[1][2] * rotation[2][1])
+                - rotation[0][1] * (rotation[1][0] * rotation[2][2] - rotation[1][2] * rotation[2][0])
+                + rotation[0][2] * (rotation[1][0] * rotation[2][1] - rotation[1][1] * rotation[2][0]);
+            if (determinant == 1) { rotations.push_back (rotation); }
+        }
+    } while (std::next_permutation (axes.begin (), axes.end ()));
+    assert (rotations.size () == 24);
+    return rotations;
 }
 
-/// \brief Find a plausible mapping from beacon indices in one scanner to beacon indices in another scanner.
-/// \param[in] done A scanner whose orientation and position are fixed.
-/// \param[in] other A scanner whose orientation and position are still unknown.
-/// \param[in] matchingPairs A list of pairs of beacon pairs that are the same distance from each other from both scanner's perspectives.
-/// \return A map from beacon indices in the done scanner to beacon indices in the other scanner.
-/// \note This is a fuzzy process where we could get false positives.  If something looks like it isnt' working out, we just silently discard it.
-std::unordered_map<Index, Index> mapBeacons (Scanner const& done, Scanner const& other, std::vector<std::pair<IndexPair, IndexPair>> const& matchingPairs) {
-    std::unordered_map<Index, Index> doneToOther;
-    std::unordered_map<Index, Index> otherToDone;
-    std::unordered_set<Index> doneIndices;
-    for (std::pair<IndexPair, IndexPair> const& match : matchingPairs) {
-        doneIndices.insert (match.first.first);
-        doneIndices.insert (match.first.second);
+/// A rotation followed by a translation, carrying one scanner's coordinates into another's.
+struct RigidTransform {
+    Rotation m_rotation;
+    Vec3 m_translation;
+
+    /// \brief Transforms a point.
+    /// \param[in] point The point.
+    /// \return The transformed point.
+    Vec3 apply (Vec3 const& point) const {
+        Vec3 rotated = rotate (m_rotation, point);
+        return {rotated.m_x + m_translation.m_x, rotated.m_y + m_translation.m_y, rotated.m_z + m_translation.m_z};
     }
 
-    for (Index doneIndex : doneIndices) {
-        for (std::pair<IndexPair, IndexPair> const& matchA : matchingPairs) {
-            if (matchA.first.first == doneIndex || matchA.first.second == doneIndex) {
-                Index matchADoneOther = (matchA.first.first == doneIndex ? matchA.first.second : matchA.first.first);
-                for (std::pair<IndexPair, IndexPair> const& matchB : matchingPairs) {
-                    if (matchB.first.first == doneIndex || matchB.first.second == doneIndex) {
-                        Index matchBDoneOther = (matchB.first.first == doneIndex ? matchB.first.second : matchB.first.first);
-                        if (matchADoneOther != matchBDoneOther) {
-                            if (matchA.second.first != matchB.second.first && matchA.second.first != matchB.second.second && matchA.second.second != matchB.second.first && matchA.second.second != matchB.second.second) {
-                                //std::cout << "Weirdly, found a match between " << matchA.first << " and " << matchB.first << " but not " << matchA.second << " and " << matchB.second << "\n";
-                                break;
-                            }
-                            // We have found two different pairs the involve the index we are currently working on.
-                            Index otherIndex = findCommonIndex (doneIndex, matchA, matchB);
-                            if (doneToOther.find (doneIndex) == doneToOther.end ()) {
-                                doneToOther.insert ({doneIndex, otherIndex});
-                            }
-                            if (otherToDone.find (otherIndex) == otherToDone.end ()) {
-                                otherToDone.insert ({otherIndex, doneIndex});
-                            }
-                            if (doneToOther.at (doneIndex) != otherIndex) {
-                                //std::cout << "Hmm, beacon " << doneIndex << " seems to be mappable to both " << doneToOther.at (doneIndex) << " and to " << otherIndex << "\n";
-                                doneToOther.erase (doneIndex);
-                            }
-                            if (otherToDone.at (otherIndex) != doneIndex) {
-                                //std::cout << "Hmm, beacon " << otherIndex << " seems to be mappable from both " << otherToDone.at (otherIndex) << " and from " << doneIndex << "\n";
-                                otherToDone.erase (otherIndex);
-                            }
-                        }
-                    }
+    /// \brief Combines two transforms.
+    /// \param[in] inner A transform to apply first.
+    /// \return A transform that applies inner, then this.
+    RigidTransform after (RigidTransform const& inner) const {
+        RigidTransform result {};
+        for (int row {0}; row < 3; ++row) {
+            for (int col {0}; col < 3; ++col) {
+                for (int mid {0}; mid < 3; ++mid) {
+                    result.m_rotation[row][col] += m_rotation[row][mid] * inner.m_rotation[mid][col];
                 }
             }
         }
+        result.m_translation = apply (inner.m_translation);
+        return result;
     }
-    return doneToOther;
-}
 
+    /// \brief Reverses this transform.
+    /// \return A transform that undoes this one.
+    RigidTransform inverse () const {
+        RigidTransform result {};
+        for (int row {0}; row < 3; ++row) {
+            for (int col {0}; col < 3; ++col) {
+                result.m_rotation[row][col] = m_rotation[col][row];
+            }
+        }
+        Vec3 back = rotate (result.m_rotation, m_translation);
+        result.m_translation = {-back.m_x, -back.m_y, -back.m_z};
+        return result;
+    }
+};
 
-/// \brief Finds the transformation matrix that transforms one scanner's position to another's.
-/// \param[in] done A scanner whose position and orientation are already known.
-/// \param[in] other A scanner whose position and orientation are not yet known.
-/// \param[in] doneToOther A mapping of beacon indices for the done scanner to beacon indices for the other scanner.
-/// \return A transformation matrix that transforms other scanner coordinates to done scanner coordinates.
-TransformationMatrix findTransformationMatrix (Scanner const& done, Scanner const& other, std::unordered_map<Index, Index> const& doneToOther) {
-    SystemOfEquations system;
-    unsigned int numAdded {0U};
-    for (unsigned int doneIndex {0U}; numAdded < 12; ++doneIndex) {
-        if (doneToOther.find (doneIndex) != doneToOther.end ()) {
-            Beacon const& doneBeacon = done.m_beacons.at (doneIndex);
-            Beacon const& otherBeacon = other.m_beacons.at (doneToOther.at (doneIndex));
-            std::vector<double> topRow (13, 0.0);
-            topRow[0] = otherBeacon.m_x;
-            topRow[1] = otherBeacon.m_y;
-            topRow[2] = otherBeacon.m_z;
-            topRow[3] = 1.0;
-            topRow[12] = doneBeacon.m_x;
-            std::vector<double> middleRow (13, 0.0);
-            middleRow[4] = otherBeacon.m_x;
-            middleRow[5] = otherBeacon.m_y;
-            middleRow[6] = otherBeacon.m_z;
-            middleRow[7] = 1.0;
-            middleRow[12] = doneBeacon.m_y;
-            std::vector<double> bottomRow (13, 0.0);
-            bottomRow[8] = otherBeacon.m_x;
-            bottomRow[9] = otherBeacon.m_y;
-            bottomRow[10] = otherBeacon.m_z;
-            bottomRow[11] = 1.0;
-            bottomRow[12] = doneBeacon.m_z;
-            system.addEquation (topRow);
-            system.addEquation (middleRow);
-            system.addEquation (bottomRow);
-            numAdded += 3;
+/// Two scanners must share this many beacons to count as overlapping.
+constexpr unsigned int OVERLAP_BEACONS = 12U;
+/// Two overlapping scanners share at least this many beacon-to-beacon distances.
+constexpr unsigned int OVERLAP_DISTANCES = OVERLAP_BEACONS * (OVERLAP_BEACONS - 1U) / 2U;
+
+/// For each beacon of a scanner, the sorted squared distances to every other beacon of that scanner.
+/// These do not change when the scanner rotates or moves, so a beacon seen by two scanners has
+///   (at least) OVERLAP_BEACONS - 1 values in common between its two fingerprints.
+using Fingerprints = std::vector<std::vector<SquaredDistance>>;
+
+/// \brief Computes the fingerprint of every beacon of a scanner.
+/// \param[in] scanner The scanner.
+/// \return The fingerprints, in beacon order.
+Fingerprints getFingerprints (Scanner const& scanner) {
+    Fingerprints fingerprints (scanner.m_beacons.size ());
+    for (Index index1 {0U}; index1 < scanner.m_beacons.size (); ++index1) {
+        for (Index index2 {0U}; index2 < scanner.m_beacons.size (); ++index2) {
+            if (index1 == index2) { continue; }
+            Vec3 const& a = scanner.m_beacons[index1];
+            Vec3 const& b = scanner.m_beacons[index2];
+            fingerprints[index1].push_back ((a.m_x - b.m_x) * (a.m_x - b.m_x) + (a.m_y - b.m_y) * (a.m_y - b.m_y) + (a.m_z - b.m_z) * (a.m_z - b.m_z));
         }
+        std::sort (fingerprints[index1].begin (), fingerprints[index1].end ());
     }
-    std::vector<double> coefficients = system.solve ();
-    return TransformationMatrix (coefficients);
+    return fingerprints;
 }
 
+/// \brief Counts the values two sorted vectors have in common.
+/// \param[in] first One sorted vector.
+/// \param[in] second Another sorted vector.
+/// \return The size of their multiset intersection.
+unsigned int countCommon (std::vector<SquaredDistance> const& first, std::vector<SquaredDistance> const& second) {
+    unsigned int count {0U};
+    auto it1 = first.begin ();
+    auto it2 = second.begin ();
+    while (it1 != first.end () && it2 != second.end ()) {
+        if (*it1 < *it2) { ++it1; }
+        else if (*it2 < *it1) { ++it2; }
+        else { ++count; ++it1; ++it2; }
+    }
+    return count;
+}
 
-/// \brief Finds one scanner whose position and orientation can be determined, and determines them.
-/// \param[inout] finished A collection of scanners whose position and orientation are already known.
-/// \param[inout] outstanding A collection of scanners whose position and orientation are not yet known.
-/// \post One scanner from outstanding has been removed and a transformed version of it added to finished.
-void searchForOverlappingScanners (SomeScanners & finished, SomeScanners & outstanding) {
-    for (std::pair<ScanID, Scanner> done : finished) {
-        for (std::pair<ScanID, Scanner> other : outstanding) {
-            std::vector<std::pair<IndexPair, IndexPair>> matches = findSameDistanceBeacons (done.second, other.second);
-            std::unordered_map<Index, Index> doneToOther = mapBeacons (done.second, other.second, matches);
-            if (doneToOther.size () >= 12) {
-                //std::cout << "It appears that scanner " << other.first << " shares visibility with scanner " << done.first << "\n";
-                TransformationMatrix transform = findTransformationMatrix (done.second, other.second, doneToOther);
-                //std::cout << transform << "\n";
-                Scanner revised {other.second};
-                for (unsigned int beaconIndex {0U}; beaconIndex < revised.m_beacons.size (); ++beaconIndex) {
-                    revised.m_beacons[beaconIndex] = transform.multiply (revised.m_beacons.at (beaconIndex));
-                }
-                revised.m_location = transform.multiply (revised.m_location);
-                outstanding.erase (revised.m_id);
-                finished.insert ({revised.m_id, revised});
-                break;
+/// \brief Finds pairs of scanners that might overlap, using an inverted index from squared distances
+///   to the scanners that see some pair of beacons that far apart.
+/// A distance can repeat within one overlap, so the count for a pair of scanners is the size of the
+///   multiset intersection: for each distance, the smaller of the two scanners' multiplicities.
+/// \param[in] fingerprints The fingerprints of every scanner.
+/// \return Pairs of scanner indices (smaller first) that share at least OVERLAP_DISTANCES distances.
+std::vector<IndexPair> findCandidatePairs (std::vector<Fingerprints> const& fingerprints) {
+    // For each distance, the scanners that see it and how many pairs of beacons each sees that far apart.
+    std::unordered_map<SquaredDistance, std::vector<std::pair<Index, unsigned int>>> scannersByDistance;
+    for (Index scanner {0U}; scanner < fingerprints.size (); ++scanner) {
+        std::vector<SquaredDistance> distances;
+        for (std::vector<SquaredDistance> const& beacon : fingerprints[scanner]) {
+            distances.insert (distances.end (), beacon.begin (), beacon.end ());
+        }
+        // Every distance appears in the fingerprints of both beacons in the pair.
+        std::sort (distances.begin (), distances.end ());
+        for (std::size_t index {0U}; index + 1U < distances.size (); index += 2U) {
+            std::vector<std::pair<Index, unsigned int>>& seenBy = scannersByDistance[distances[index]];
+            if (!seenBy.empty () && seenBy.back ().first == scanner) { ++seenBy.back ().second; }
+            else { seenBy.push_back ({scanner, 1U}); }
+        }
+    }
+    std::unordered_map<IndexPair, unsigned int> sharedCounts;
+    for (auto const& [distance, seenBy] : scannersByDistance) {
+        for (std::size_t first {0U}; first < seenBy.size (); ++first) {
+            for (std::size_t second {first + 1U}; second < seenBy.size (); ++second) {
+                sharedCounts[{seenBy[first].first, seenBy[second].first}] += std::min (seenBy[first].second, seenBy[second].second);
             }
         }
     }
+    std::vector<IndexPair> candidates;
+    for (auto const& entry : sharedCounts) {
+        if (entry.second >= OVERLAP_DISTANCES) { candidates.push_back (entry.first); }
+    }
+    std::sort (candidates.begin (), candidates.end ());
+    return candidates;
 }
 
-
-/// \brief Finds the largest Manhattan distance between two scanners.
-/// \param[in] scanners A collection of all of the scanners.
-/// \return The largest Manhattan distance between any two scanners.
-long furthestDistance (SomeScanners const& scanners) {
-    long furthest = 0L;
-    for (std::pair<ScanID, Scanner> const& scan1 : scanners) {
-        for (std::pair<ScanID, Scanner> const& scan2 : scanners) {
-            long distance = std::abs (scan1.second.m_location.m_x - scan2.second.m_location.m_x);
-            distance += std::abs (scan1.second.m_location.m_y - scan2.second.m_location.m_y);
-            distance += std::abs (scan1.second.m_location.m_z - scan2.second.m_location.m_z);
-            if (distance > furthest) { furthest = distance; }
+/// \brief Tries to find the transform from one scanner's coordinates to another's.
+/// Beacons are paired up by fingerprint overlap, then each of the 24 rotations is tested to see
+///   whether it (plus the translation implied by one pair) lines up enough of the pairs.
+/// \param[in] fixed The scanner whose coordinates are the target.
+/// \param[in] fixedPrints The fingerprints of fixed's beacons.
+/// \param[in] other The scanner whose coordinates are the source.
+/// \param[in] otherPrints The fingerprints of other's beacons.
+/// \param[in] rotations All 24 rotations.
+/// \return The transform, or nothing if the scanners do not actually overlap.
+std::optional<RigidTransform> alignScanners (Scanner const& fixed, Fingerprints const& fixedPrints, Scanner const& other, Fingerprints const& otherPrints, std::vector<Rotation> const& rotations) {
+    std::vector<IndexPair> correspondences;
+    for (Index fixedIndex {0U}; fixedIndex < fixedPrints.size (); ++fixedIndex) {
+        for (Index otherIndex {0U}; otherIndex < otherPrints.size (); ++otherIndex) {
+            if (countCommon (fixedPrints[fixedIndex], otherPrints[otherIndex]) >= OVERLAP_BEACONS - 1U) {
+                correspondences.push_back ({fixedIndex, otherIndex});
+            }
         }
     }
-    return furthest;
+    if (correspondences.size () < OVERLAP_BEACONS) { return std::nullopt; }
+
+    // A false correspondence would give a wrong translation, so try a few different anchors.
+    for (std::size_t anchor {0U}; anchor < correspondences.size () && anchor < 4U; ++anchor) {
+        Vec3 const& fixedAnchor = fixed.m_beacons[correspondences[anchor].first];
+        Vec3 const& otherAnchor = other.m_beacons[correspondences[anchor].second];
+        for (Rotation const& rotation : rotations) {
+            Vec3 rotated = rotate (rotation, otherAnchor);
+            RigidTransform transform {rotation, {fixedAnchor.m_x - rotated.m_x, fixedAnchor.m_y - rotated.m_y, fixedAnchor.m_z - rotated.m_z}};
+            unsigned int agreeing {0U};
+            for (IndexPair const& correspondence : correspondences) {
+                if (transform.apply (other.m_beacons[correspondence.second]) == fixed.m_beacons[correspondence.first]) {
+                    ++agreeing;
+                }
+            }
+            if (agreeing >= OVERLAP_BEACONS) { return transform; }
+        }
+    }
+    return std::nullopt;
 }
 
+/// \brief Places every scanner relative to the first one.
+/// Candidate overlaps are aligned in parallel, then the scanners are placed by a breadth-first
+///   search over the overlap graph, composing transforms along the way.
+/// \param[in] scanners All of the scanners, in ID order.
+/// \return For each scanner, the transform from its coordinates to the first scanner's.
+std::vector<RigidTransform> placeScanners (std::vector<Scanner> const& scanners) {
+    std::vector<Rotation> rotations = getAllRotations ();
+    std::vector<Fingerprints> fingerprints;
+    for (Scanner const& scanner : scanners) {
+        fingerprints.push_back (getFingerprints (scanner));
+    }
+    std::vector<IndexPair> candidates = findCandidatePairs (fingerprints);
+
+    std::vector<std::optional<RigidTransform>> alignments (candidates.size ());
+    forEachIndex (candidates.size (), [&] (std::size_t index, unsigned int) {
+        Index first = candidates[index].first;
+        Index second = candidates[index].second;
+        alignments[index] = alignScanners (scanners[first], fingerprints[first], scanners[second], fingerprints[second], rotations);
+    });
+
+    // For each scanner, its neighbors and the transforms from their coordinates to its own.
+    std::vector<std::vector<std::pair<Index, RigidTransform>>> overlaps (scanners.size ());
+    for (std::size_t index {0U}; index < candidates.size (); ++index) {
+        if (alignments[index]) {
+            overlaps[candidates[index].first].push_back ({candidates[index].second, *alignments[index]});
+            overlaps[candidates[index].second].push_back ({candidates[index].first, alignments[index]->inverse ()});
+        }
+    }
 
+    std::vector<std::optional<RigidTransform>> placed (scanners.size ());
+    placed[0] = RigidTransform {{{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}}, {0, 0, 0}};
+    std::deque<Index> frontier {0U};
+    while (!frontier.empty ()) {
+        Index current = frontier.front ();
+        frontier.pop_front ();
+        for (auto const& [neighbor, transform] : overlaps[current]) {
+            if (!placed[neighbor]) {
+                placed[neighbor] = placed[current]->after (transform);
+                frontier.push_back (neighbor);
+            }
+        }
+    }
+    std::vector<RigidTransform> result;
+    for (std::optional<RigidTransform> const& transform : placed) {
+        if (!transform) { throw std::runtime_error ("Some scanner does not overlap any other."); }
+        result.push_back (*transform);
+    }
+    return result;
+}
 
 /// \brief Runs the prorgram.
 /// \return Always 0.
 int main () {
     SomeScanners problem = getInput ();
-    SomeScanners finished;
-    SomeScanners outstanding;
-    finished.insert ({0U, problem.at (0U)});
-    outstanding = problem;
-    outstanding.erase (0U);
-    while (!outstanding.empty ()) {
-        searchForOverlappingScanners (finished, outstanding);
+    std::vector<Scanner> scanners;
+    for (ScanID id {0U}; id < problem.size (); ++id) {
+        scanners.push_back (problem.at (id));
     }
+    std::vector<RigidTransform> transforms = placeScanners (scanners);
     std::unordered_set<Beacon> allBeacons;
-    for (std::pair<ScanID, Scanner> const& scan : finished) {
-        for (Beacon const& beacon : scan.second.m_beacons) {
-            allBeacons.insert (beacon);
+    long furthest = 0L;
+    for (Index index {0U}; index < scanners.size (); ++index) {
+        for (Beacon const& beacon : scanners[index].m_beacons) {
+            allBeacons.insert (transforms[index].apply (beacon));
+        }
+        for (Index other {0U}; other < index; ++other) {
+            Vec3 const& a = transforms[index].m_translation;
+            Vec3 const& b = transforms[other].m_translation;
+            furthest = std::max (furthest, std::abs (a.m_x - b.m_x) + std::abs (a.m_y - b.m_y) + std::abs (a.m_z - b.m_z));
         }
     }
     std::cout << allBeacons.size () << "\n";
-    std::cout << furthestDistance (finished) << "\n";
+    std::cout << furthest << "\n";
     return 0;
-}
\ No newline at end of file
+}
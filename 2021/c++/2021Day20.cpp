@@ -9,6 +9,10 @@
 #include <string>
 #include <cassert>
 #include <vector>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
 
 #include "utilities.hpp"
 
@@ -126,13 +130,139 @@ unsigned int countLights (Problem const& input) {
 }
 
 
+/// An image stored one byte per pixel in a buffer padded enough that it never has to grow while
+///   being enhanced a fixed number of times.  Enhancement ping-pongs between two such buffers.
+class PaddedImage {
+public:
+    /// \brief Constructs a padded image.
+    /// \param[in] problem The enhancement algorithm and starting image.
+    /// \param[in] iterations The maximum number of times it will be enhanced.
+    PaddedImage (Problem const& problem, unsigned int iterations)
+        : m_padding {iterations + 2U},
+          m_rows {problem.m_image.size ()},
+          m_cols {problem.m_image.empty () ? 0U : problem.m_image.front ().size ()},
+          m_width {m_cols + 2U * m_padding},
+          m_current ((m_rows + 2U * m_padding) * m_width, problem.m_infiniteIsLit),
+          m_next (m_current.size (), 0U),
+          m_top {m_padding},
+          m_left {m_padding},
+          m_background {problem.m_infiniteIsLit},
+          m_remaining {iterations} {
+        if (problem.m_algorithm.size () != m_algorithm.size ()) { throw std::runtime_error ("The algorithm must have 512 entries."); }
+        for (std::size_t index {0U}; index < m_algorithm.size (); ++index) { m_algorithm[index] = problem.m_algorithm[index]; }
+        for (std::size_t row {0U}; row < m_rows; ++row) {
+            std::copy (problem.m_image[row].begin (), problem.m_image[row].end (), m_current.begin () + (m_top + row) * m_width + m_left);
+        }
+    }
+
+    /// \brief Applies the enhancement algorithm once.
+    void enhance () {
+        if (m_remaining == 0U) { throw std::runtime_error ("The image was not padded for this many enhancements."); }
+        --m_remaining;
+        --m_top;
+        --m_left;
+        m_rows += 2U;
+        m_cols += 2U;
+        // Spinning up threads costs more than enhancing a small image.
+        constexpr std::size_t PIXELS_PER_THREAD {1U << 16};
+        std::size_t numBands {std::min<std::size_t> (workerCount (), m_rows * m_cols / PIXELS_PER_THREAD + 1U)};
+        forEachIndex (numBands, [this, numBands] (std::size_t band, unsigned int) {
+            enhanceRows (m_top + m_rows * band / numBands, m_top + m_rows * (band + 1U) / numBands);
+        });
+        m_background = m_algorithm[m_background ? 511U : 0U];
+        fillBorder ();
+        std::swap (m_current, m_next);
+    }
+
+    /// \brief Counts the lit pixels in the part of the image that is not infinite background.
+    /// \return The number of lit pixels.
+    std::size_t countLights () const {
+        std::size_t count {0U};
+        for (std::size_t row {m_top}; row < m_top + m_rows; ++row) {
+            auto start = m_current.begin () + row * m_width + m_left;
+            count += std::count (start, start + m_cols, 1U);
+        }
+        return count;
+    }
+
+private:
+    /// \brief Computes some rows of the next image from the current one.
+    /// The 9-bit index slides along each row: the oldest column is shifted out and a new one shifted in.
+    /// \param[in] first The first row to compute.
+    /// \param[in] last One past the last row to compute.
+    void enhanceRows (std::size_t first, std::size_t last) {
+        constexpr unsigned int KEEP_TWO_COLUMNS {0b110110110U};
+        for (std::size_t row {first}; row < last; ++row) {
+            std::uint8_t const* above {&m_current[(row - 1U) * m_width]};
+            std::uint8_t const* middle {&m_current[row * m_width]};
+            std::uint8_t const* below {&m_current[(row + 1U) * m_width]};
+            std::uint8_t* output {&m_next[row * m_width]};
+            unsigned int index {0U};
+            for (std::size_t col {m_left - 1U}; col < m_left + 1U; ++col) {
+                index = ((index << 1) & KEEP_TWO_COLUMNS) | (above[col] << 6) | (middle[col] << 3) | below[col];
+            }
+            for (std::size_t col {m_left}; col < m_left + m_cols; ++col) {
+                index = ((index << 1) & KEEP_TWO_COLUMNS) | (above[col + 1U] << 6) | (middle[col + 1U] << 3) | below[col + 1U];
+                output[col] = m_algorithm[index];
+            }
+        }
+    }
+
+    /// \brief Sets the two rings of pixels around the new image to the background colour.
+    /// That is exactly what the next enhancement will read beyond what was computed.
+    void fillBorder () {
+        std::size_t firstCol {m_left - 2U};
+        std::size_t lastCol {m_left + m_cols + 2U};
+        for (std::size_t row : {m_top - 2U, m_top - 1U, m_top + m_rows, m_top + m_rows + 1U}) {
+            std::fill (m_next.begin () + row * m_width + firstCol, m_next.begin () + row * m_width + lastCol, m_background);
+        }
+        for (std::size_t row {m_top}; row < m_top + m_rows; ++row) {
+            for (std::size_t col : {m_left - 2U, m_left - 1U, m_left + m_cols, m_left + m_cols + 1U}) {
+                m_next[row * m_width + col] = m_background;
+            }
+        }
+    }
+
+    std::array<std::uint8_t, 512> m_algorithm;
+    /// How far beyond the original image the buffers extend on every side.
+    std::size_t m_padding;
+    /// The size of the part of the image that is not infinite background.
+    std::size_t m_rows;
+    std::size_t m_cols;
+    /// The width of the buffers.
+    std::size_t m_width;
+    std::vector<std::uint8_t> m_current;
+    std::vector<std::uint8_t> m_next;
+    /// Where in the buffers the part of the image that is not infinite background starts.
+    std::size_t m_top;
+    std::size_t m_left;
+    std::uint8_t m_background;
+    unsigned int m_remaining;
+};
+
+
 /// \brief Runs the prorgram.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv An optional number of enhancements to also count lights after.
 /// \return Always 0.
-int main () {
+int main (int argc, char* argv[]) {
     Problem problem = getInput ();
-    Problem after2 = iterate (problem, 2);
-    std::cout << countLights (after2) << "\n";
-    Problem after50 = iterate (after2, 48);
-    std::cout << countLights (after50) << "\n";
+    PaddedImage image (problem, 50U);
+    image.enhance ();
+    image.enhance ();
+    std::cout << image.countLights () << "\n";
+    for (unsigned int count {2U}; count < 50U; ++count) {
+        image.enhance ();
+    }
+    std::cout << image.countLights () << "\n";
+
+    if (argc > 1) {
+        unsigned int iterations = std::stoul (argv[1]);
+        PaddedImage grown (problem, iterations);
+        for (unsigned int count {0U}; count < iterations; ++count) {
+            grown.enhance ();
+        }
+        std::cout << grown.countLights () << "\n";
+    }
     return 0;
-}
\ No newline at end of file
+}
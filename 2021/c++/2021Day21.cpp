@@ -8,6 +8,10 @@
 #include <cstdio>
 #include <cassert>
 #include <unordered_map>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
 
 #include "utilities.hpp"
 
@@ -130,18 +134,142 @@ WinCounts continueGame (GameState const& current) {
     }
 }
 
+/// The rules of a Dirac dice game, which can be bigger than the real one.
+struct DiracRules {
+    /// The score a player needs to win.
+    unsigned int winThreshold;
+    /// The number of spaces on the board.
+    unsigned int boardSize;
+    /// The number of faces on the die.
+    unsigned int dieFaces;
+    /// The number of times the die is rolled each turn.
+    unsigned int rollsPerTurn;
+};
+
+/// \brief Counts how many universes move a pawn each distance around the board in one turn.
+/// \param[in] rules The rules of the game.
+/// \return For each distance (modulo the board size), how many universes it is moved that far in.
+template<typename Count>
+std::vector<Count> getMoveMultiplicities (DiracRules const& rules) {
+    std::vector<Count> ways (rules.boardSize, Count {0U});
+    ways[0] = 1U;
+    for (unsigned int roll {0U}; roll < rules.rollsPerTurn; ++roll) {
+        std::vector<Count> next (rules.boardSize, Count {0U});
+        for (unsigned int distance {0U}; distance < rules.boardSize; ++distance) {
+            for (unsigned int face {1U}; face <= rules.dieFaces; ++face) {
+                next[(distance + face) % rules.boardSize] += ways[distance];
+            }
+        }
+        ways = next;
+    }
+    return ways;
+}
+
+/// \brief Counts the universes each player wins in, bottom-up over tables of game states.
+/// A state is seen from the point of view of the player about to move, so the player whose turn it is
+///   does not need to be part of it: for every pair of scores below the threshold and every pair of
+///   positions, the tables hold the wins of the mover and of the other player.  A move turns a state with
+///   scores (mover, other) into one with scores (other, mover + something), where the something is
+///   between 1 and the board size, so states are filled in decreasing order of total score and only the
+///   board size's worth of totals above the current one are ever read.  The tables therefore keep one
+///   layer per total in a ring of that many layers plus one, rather than every pair of scores.
+/// Each block of positions is stored transposed so that the loop over the other player's position reads
+///   contiguous memory; a block is summed in scratch rows and then transposed into its layer.
+/// \param[in] start The 1-based starting positions of the players.
+/// \param[in] rules The rules of the game.
+/// \return The number of universes player 1 wins in and the number player 2 wins in.
+template<typename Count>
+std::pair<Count, Count> countDiracWins (Positions const& start, DiracRules const& rules) {
+    std::size_t const board {rules.boardSize};
+    std::size_t const scores {rules.winThreshold};
+    std::size_t const blockSize {board * board};
+    std::size_t const layers {std::min (board + 1U, 2U * scores - 1U)};
+    auto block = [&] (std::size_t moverScore, std::size_t otherScore) {
+        return (((moverScore + otherScore) % layers) * scores + moverScore) * blockSize;
+    };
+    // Indexed [total % layers][moverScore][otherPosition][moverPosition].
+    std::vector<Count> moverWinsT (layers * scores * blockSize, Count {0U});
+    std::vector<Count> otherWinsT (moverWinsT.size (), Count {0U});
+    // The block being filled in, indexed [moverPosition][otherPosition].
+    std::vector<Count> moverWins (blockSize);
+    std::vector<Count> otherWins (blockSize);
+    std::vector<Count> const moves {getMoveMultiplicities<Count> (rules)};
+
+    for (std::size_t total {2U * scores - 1U}; total-- > 0U;) {
+        for (std::size_t moverScore {total < scores ? 0U : total - scores + 1U}; moverScore <= std::min (total, scores - 1U); ++moverScore) {
+            std::size_t otherScore {total - moverScore};
+            std::fill (moverWins.begin (), moverWins.end (), Count {0U});
+            std::fill (otherWins.begin (), otherWins.end (), Count {0U});
+            for (std::size_t moverPosition {0U}; moverPosition < board; ++moverPosition) {
+                Count* moverRow {&moverWins[moverPosition * board]};
+                Count* otherRow {&otherWins[moverPosition * board]};
+                for (std::size_t distance {0U}; distance < board; ++distance) {
+                    Count const ways {moves[distance]};
+                    if (ways == 0U) { continue; }
+                    std::size_t landing {(moverPosition + distance) % board};
+                    std::size_t newScore {moverScore + landing + 1U};
+                    if (newScore >= scores) {
+                        for (std::size_t otherPosition {0U}; otherPosition < board; ++otherPosition) {
+                            moverRow[otherPosition] += ways;
+                        }
+                    }
+                    else {
+                        // Afterwards the other player moves from otherPosition, and this one waits at landing.
+                        std::size_t there {block (otherScore, newScore) + landing * board};
+                        Count const* theirWins {&moverWinsT[there]};
+                        Count const* ourWins {&otherWinsT[there]};
+                        for (std::size_t otherPosition {0U}; otherPosition < board; ++otherPosition) {
+                            moverRow[otherPosition] += ways * ourWins[otherPosition];
+                            otherRow[otherPosition] += ways * theirWins[otherPosition];
+                        }
+                    }
+                }
+            }
+            std::size_t here {block (moverScore, otherScore)};
+            for (std::size_t moverPosition {0U}; moverPosition < board; ++moverPosition) {
+                for (std::size_t otherPosition {0U}; otherPosition < board; ++otherPosition) {
+                    moverWinsT[here + otherPosition * board + moverPosition] = moverWins[moverPosition * board + otherPosition];
+                    otherWinsT[here + otherPosition * board + moverPosition] = otherWins[moverPosition * board + otherPosition];
+                }
+            }
+        }
+    }
+
+    std::size_t initial {block (0U, 0U) + (start.second - BOARD_MIN) * board + (start.first - BOARD_MIN)};
+    return {moverWinsT[initial], otherWinsT[initial]};
+}
+
+/// \brief Converts a 128-bit count to decimal.
+/// \param[in] value The count.
+/// \return Its decimal representation.
+std::string toString (unsigned __int128 value) {
+    std::string digits;
+    do {
+        digits.push_back ('0' + (unsigned int)(value % 10U));
+        value /= 10U;
+    } while (value != 0U);
+    std::reverse (digits.begin (), digits.end ());
+    return digits;
+}
+
 /// \brief Runs the program.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv Optionally a win threshold, board size and number of die faces for a bigger Dirac game.
 /// \return Always 0.
-int main () {
+int main (int argc, char* argv[]) {
     Positions initial = getInput ();
     std::cout << playUntilWin (initial, PART1_TARGET) << "\n";
-    GameState current {initial, {0U, 0U}, true};
-    WinCounts counts = continueGame (current);
-    if (counts.first > counts.second) {
-        std::cout << counts.first << "\n";
-    }
-    else {
-        std::cout << counts.second << "\n";
+    DiracRules const rules {PART2_TARGET, BOARD_MAX - BOARD_MIN + 1U, DIRAC_DIE_MAX - DIRAC_DIE_MIN + 1U, DIE_ROLLS};
+    WinCounts counts = countDiracWins<unsigned long long> (initial, rules);
+    std::cout << std::max (counts.first, counts.second) << "\n";
+
+    if (argc > 3) {
+        DiracRules const variant {(unsigned int)std::stoul (argv[1]), (unsigned int)std::stoul (argv[2]), (unsigned int)std::stoul (argv[3]), DIE_ROLLS};
+        if (initial.first > variant.boardSize || initial.second > variant.boardSize) {
+            throw std::runtime_error ("The starting positions do not fit on that board.");
+        }
+        auto bigCounts = countDiracWins<unsigned __int128> (initial, variant);
+        std::cout << toString (bigCounts.first) << " " << toString (bigCounts.second) << "\n";
     }
     return 0;
-}
\ No newline at end of file
+}
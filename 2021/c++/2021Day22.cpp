@@ -10,6 +10,11 @@
 #include <cassert>
 #include <vector>
 #include <climits>
+#include <array>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <unordered_map>
 
 #include "utilities.hpp"
 
@@ -17,20 +22,6 @@ struct Region {
     int m_minX, m_maxX, m_minY, m_maxY, m_minZ, m_maxZ;
     bool m_on;
 
-    unsigned long long size () const {
-        return (unsigned long long)(m_maxX - m_minX + 1) * (unsigned long long)(m_maxY - m_minY + 1) * (unsigned long long)(m_maxZ - m_minZ + 1);
-    }
-
-    bool intersects (Region const& other) const {
-        if (m_minX > other.m_maxX) { return false; }
-        if (m_minY > other.m_maxY) { return false; }
-        if (m_minZ > other.m_maxZ) { return false; }
-        if (m_maxX < other.m_minX) { return false; }
-        if (m_maxY < other.m_minY) { return false; }
-        if (m_maxZ < other.m_minZ) { return false; }
-        return true;
-    }
-
     bool isValid () const {
         return m_minX <= m_maxX && m_minY <= m_maxY && m_minZ <= m_maxZ;
     }
@@ -45,61 +36,6 @@ struct Region {
         result.m_maxZ = std::min (m_maxZ, other.m_maxZ);
         return result;
     }
-
-    std::vector<Region> inMeButNotOther (Region const& other) const {
-        if (!intersects (other)) { return {*this}; };
-
-        int topPlane, bottomPlane, leftPlane, rightPlane;
-        std::vector<Region> regions;
-
-        if (m_maxY > other.m_maxY) {
-            topPlane = other.m_maxY;
-            regions.push_back ({m_minX, m_maxX, other.m_maxY + 1, m_maxY, m_minZ, m_maxZ, m_on});
-            assert (regions.back ().isValid ());
-        }
-        else {
-            topPlane = m_maxY;
-        }
-
-        if (m_minY < other.m_minY) {
-            bottomPlane = other.m_minY;
-            regions.push_back ({m_minX, m_maxX, m_minY, other.m_minY - 1, m_minZ, m_maxZ, m_on});
-            assert (regions.back ().isValid ());
-        }
-        else {
-            bottomPlane = m_minY;
-        }
-
-        if (m_minX < other.m_minX) {
-            leftPlane = other.m_minX;
-            regions.push_back ({m_minX, other.m_minX - 1, bottomPlane, topPlane, m_minZ, m_maxZ, m_on});
-            assert (regions.back ().isValid ());
-        }
-        else {
-            leftPlane = m_minX;
-        }
-
-        if (m_maxX > other.m_maxX) {
-            rightPlane = other.m_maxX;
-            regions.push_back ({other.m_maxX + 1, m_maxX, bottomPlane, topPlane, m_minZ, m_maxZ, m_on});
-            assert (regions.back ().isValid ());
-        }
-        else {
-            rightPlane = m_maxX;
-        }
-
-        if (m_minZ < other.m_minZ) {
-            regions.push_back ({leftPlane, rightPlane, bottomPlane, topPlane, m_minZ, other.m_minZ - 1, m_on});
-            assert (regions.back ().isValid ());
-        }
-
-        if (m_maxZ > other.m_maxZ) {
-            regions.push_back ({leftPlane, rightPlane, bottomPlane, topPlane, other.m_maxZ + 1, m_maxZ, m_on});
-            assert (regions.back ().isValid ());
-        }
-
-        return regions;
-    }
 };
 
 
@@ -128,112 +64,259 @@ Steps getInput () {
 }
 
 
-unsigned long part1BruteForce (Steps const& steps) {
-    constexpr int OFFSET = 50;
-    constexpr int INTERESTING_SIZE = 101;
-    bool cubes[INTERESTING_SIZE][INTERESTING_SIZE][INTERESTING_SIZE];
-    unsigned long count {0UL};
-    for (Region const& step : steps) {
-        Region adjusted;
-        adjusted.m_minX = std::max (0, step.m_minX + OFFSET);
-        adjusted.m_maxX = std::min (INTERESTING_SIZE - 1, step.m_maxX + OFFSET);
-        adjusted.m_minY = std::max (0, step.m_minY + OFFSET);
-        adjusted.m_maxY = std::min (INTERESTING_SIZE - 1, step.m_maxY + OFFSET);
-        adjusted.m_minZ = std::max (0, step.m_minZ + OFFSET);
-        adjusted.m_maxZ = std::min (INTERESTING_SIZE - 1, step.m_maxZ + OFFSET);
-        for (int x {adjusted.m_minX}; x <= adjusted.m_maxX; ++x) {
-            for (int y {adjusted.m_minY}; y <= adjusted.m_maxY; ++y) {
-                for (int z {adjusted.m_minZ}; z <= adjusted.m_maxZ; ++z) {
-                    if (step.m_on && !cubes[x][y][z]) {
-                        ++count;
-                        cubes[x][y][z] = true;
-                    }
-                    else if (!step.m_on && cubes[x][y][z]) {
-                        --count;
-                        cubes[x][y][z] = false;
-                    }
-                }
-            }
+/// \brief Hashes the six bounds of a cuboid.
+struct CuboidHash {
+    std::size_t operator() (std::array<int, 6> const& bounds) const {
+        std::size_t hash {0U};
+        for (int bound : bounds) {
+            hash = hash * 1234567U + (unsigned int)bound;
         }
+        return hash;
     }
-    return count;
-}
+};
 
+/// \brief A collection of cuboids with signed weights, whose weighted volumes add up to the number of
+///   cubes that are on (inclusion-exclusion).  Each bound lives in its own array so that testing a new
+///   step against every entry is a straight loop over contiguous memory.
+class SignedCuboids {
+public:
+    /// \brief Applies a reboot step.
+    /// \param[in] step The step.
+    /// \post Every entry's overlap with the step has been added with the opposite weight, and if the step
+    ///   turns cubes on it has been added with weight 1.  Entries that cancel out are removed once they
+    ///   make up a quarter of the table.
+    void apply (Region const& step) {
+        // Clip every entry against the step into the overlap buffers first.  The loop has no branches or
+        //   lookups, so it runs as straight min/max/compare over the arrays.  The step itself goes in the
+        //   last slot, flagged only if it turns cubes on.
+        std::size_t size {m_weights.size ()};
+        for (std::vector<int>* bounds : {&m_overlapMinX, &m_overlapMaxX, &m_overlapMinY, &m_overlapMaxY, &m_overlapMinZ, &m_overlapMaxZ}) {
+            bounds->resize (size + 1U);
+        }
+        m_overlapWeights.resize (size + 1U);
+        m_overlaps.resize (size + 1U);
+        for (std::size_t index {0U}; index < size; ++index) {
+            m_overlapMinX[index] = std::max (m_minX[index], step.m_minX);
+            m_overlapMaxX[index] = std::min (m_maxX[index], step.m_maxX);
+            m_overlapMinY[index] = std::max (m_minY[index], step.m_minY);
+            m_overlapMaxY[index] = std::min (m_maxY[index], step.m_maxY);
+            m_overlapMinZ[index] = std::max (m_minZ[index], step.m_minZ);
+            m_overlapMaxZ[index] = std::min (m_maxZ[index], step.m_maxZ);
+            m_overlapWeights[index] = -m_weights[index];
+            m_overlaps[index] = (m_overlapMinX[index] <= m_overlapMaxX[index]) & (m_overlapMinY[index] <= m_overlapMaxY[index]) & (m_overlapMinZ[index] <= m_overlapMaxZ[index]) & (m_weights[index] != 0);
+        }
+        m_overlapMinX[size] = step.m_minX;
+        m_overlapMaxX[size] = step.m_maxX;
+        m_overlapMinY[size] = step.m_minY;
+        m_overlapMaxY[size] = step.m_maxY;
+        m_overlapMinZ[size] = step.m_minZ;
+        m_overlapMaxZ[size] = step.m_maxZ;
+        m_overlapWeights[size] = 1;
+        m_overlaps[size] = step.m_on;
 
-unsigned long long addSizes (std::vector<Region> const& regions) {
-    unsigned long long count {0ULL};
-    for (Region const& region : regions) {
-        count += region.size ();
-    }
-    return count;
-}
+        // Combine overlaps with equal bounds among themselves before merging, so that a cuboid which nets
+        //   out to 0 within this step never enters the table.
+        m_order.clear ();
+        for (std::size_t index {0U}; index <= size; ++index) {
+            if (m_overlaps[index]) { m_order.push_back (index); }
+        }
+        auto boundsAt = [&] (std::size_t index) {
+            return std::array<int, 6> {m_overlapMinX[index], m_overlapMaxX[index], m_overlapMinY[index], m_overlapMaxY[index], m_overlapMinZ[index], m_overlapMaxZ[index]};
+        };
+        std::sort (m_order.begin (), m_order.end (), [&] (std::size_t left, std::size_t right) {
+            return boundsAt (left) < boundsAt (right);
+        });
 
-std::vector<Region> process (std::vector<Region> const& onRegions, Region const& step) {
-    std::vector<Region> revised {onRegions};
-    std::vector<Region> toAdd;
-    toAdd.push_back (step);
-    while (!toAdd.empty ()) {
-        std::vector<Region> temp {revised};
-        revised.clear ();
-        Region next = toAdd.back ();
-        toAdd.pop_back ();
-
-        if (next.m_on) {
-            // adding regions
-            bool didASplit = false;
-            for (Region const& existing : temp) {
-                if (didASplit || !next.intersects (existing)) {
-                    revised.push_back (existing);
-                }
-                else {
-                    Region intersection = next.intersection (existing);
-                    std::vector<Region> inNext = next.inMeButNotOther (existing);
-                    std::vector<Region> inExisting = existing.inMeButNotOther (next);
-                    assert (addSizes (inNext ) + intersection.size () == next.size ());
-                    assert (addSizes (inExisting) + intersection.size () == existing.size ());
-                    revised.push_back (intersection);
-                    for (Region const& piece : inExisting) { revised.push_back (piece); }
-                    for (Region const& piece : inNext) { toAdd.push_back (piece); }
-                    didASplit = true;
-                }
+        for (std::size_t first {0U}, last {0U}; first < m_order.size (); first = last) {
+            std::array<int, 6> bounds {boundsAt (m_order[first])};
+            long long weight {0LL};
+            for (last = first; last < m_order.size () && boundsAt (m_order[last]) == bounds; ++last) {
+                weight += m_overlapWeights[m_order[last]];
             }
-            if (!didASplit) { revised.push_back (next); }
-        }
-        else {
-            // shrinking existing regions
-            for (Region const& existing : temp) {
-                if (!next.intersects (existing)) {
-                    revised.push_back (existing);
-                }
-                else {
-                    Region intersection = next.intersection (existing);
-                    std::vector<Region> inNext = next.inMeButNotOther (existing);
-                    std::vector<Region> inExisting = existing.inMeButNotOther (next);
-                    assert (addSizes (inNext ) + intersection.size () == next.size ());
-                    assert (addSizes (inExisting) + intersection.size () == existing.size ());
-                    for (Region const& piece : inExisting) { revised.push_back (piece); }                    
-                }
+            auto found = m_indices.find (bounds);
+            if (found != m_indices.end ()) {
+                long long& existing {m_weights[found->second]};
+                m_cancelled -= existing == 0;
+                existing += weight;
+                m_cancelled += existing == 0;
             }
+            else if (weight != 0) {
+                m_indices[bounds] = m_weights.size ();
+                m_minX.push_back (bounds[0]);
+                m_maxX.push_back (bounds[1]);
+                m_minY.push_back (bounds[2]);
+                m_maxY.push_back (bounds[3]);
+                m_minZ.push_back (bounds[4]);
+                m_maxZ.push_back (bounds[5]);
+                m_weights.push_back (weight);
+            }
+        }
+        // Rebuilding the index costs a pass over the whole table, so cancelled entries (which contribute
+        //   nothing) are left in place until there are enough of them to pay for it.
+        if (4U * m_cancelled > m_weights.size ()) {
+            removeCancelled ();
         }
     }
-    return revised;
-}
 
-unsigned long long part2Dos (Steps const& steps) {
-    std::vector<Region> onRegions;
+    /// \brief Gets the number of cubes that are on.
+    /// \return The sum of each entry's weight times its volume.
+    long long volume () const {
+        long long total {0LL};
+        for (std::size_t index {0U}; index < m_weights.size (); ++index) {
+            total += m_weights[index] * (long long)(m_maxX[index] - m_minX[index] + 1) * (long long)(m_maxY[index] - m_minY[index] + 1) * (long long)(m_maxZ[index] - m_minZ[index] + 1);
+        }
+        return total;
+    }
+
+private:
+    /// \brief Compacts the arrays, dropping entries whose weight is 0.
+    void removeCancelled () {
+        m_indices.clear ();
+        std::size_t kept {0U};
+        for (std::size_t index {0U}; index < m_weights.size (); ++index) {
+            if (m_weights[index] == 0) { continue; }
+            m_minX[kept] = m_minX[index];
+            m_maxX[kept] = m_maxX[index];
+            m_minY[kept] = m_minY[index];
+            m_maxY[kept] = m_maxY[index];
+            m_minZ[kept] = m_minZ[index];
+            m_maxZ[kept] = m_maxZ[index];
+            m_weights[kept] = m_weights[index];
+            m_indices[{m_minX[kept], m_maxX[kept], m_minY[kept], m_maxY[kept], m_minZ[kept], m_maxZ[kept]}] = kept;
+            ++kept;
+        }
+        for (std::vector<int>* bounds : {&m_minX, &m_maxX, &m_minY, &m_maxY, &m_minZ, &m_maxZ}) {
+            bounds->resize (kept);
+        }
+        m_weights.resize (kept);
+        m_cancelled = 0U;
+    }
+
+    std::vector<int> m_minX, m_maxX, m_minY, m_maxY, m_minZ, m_maxZ;
+    std::vector<long long> m_weights;
+    std::unordered_map<std::array<int, 6>, std::size_t, CuboidHash> m_indices;
+    std::size_t m_cancelled {0U};
+    // Scratch space for apply, kept between steps to avoid reallocating.
+    std::vector<int> m_overlapMinX, m_overlapMaxX, m_overlapMinY, m_overlapMaxY, m_overlapMinZ, m_overlapMaxZ;
+    std::vector<long long> m_overlapWeights;
+    std::vector<unsigned char> m_overlaps;
+    std::vector<std::size_t> m_order;
+};
+
+/// \brief Trims every step to a bounding region, dropping the ones that miss it.
+/// \param[in] steps The steps.
+/// \param[in] bounds The region to trim to.
+/// \return The trimmed steps, in the same order.
+Steps clipSteps (Steps const& steps, Region const& bounds) {
+    Steps clipped;
+    for (Region const& step : steps) {
+        Region piece = step.intersection (bounds);
+        if (piece.isValid ()) {
+            piece.m_on = step.m_on;
+            clipped.push_back (piece);
+        }
+    }
+    return clipped;
+}
 
+/// \brief Counts the cubes that are on, using inclusion-exclusion.
+/// Space is cut into x-slabs with roughly equal numbers of step boundaries, and since no cuboid crosses
+///   a slab boundary after clipping, each slab is an independent problem for its own thread.
+/// \param[in] steps The steps.
+/// \return The number of cubes that are on after all steps.
+long long countOnCubes (Steps const& steps) {
+    if (steps.empty ()) { return 0LL; }
+    std::vector<int> boundaries;
     for (Region const& step : steps) {
-        onRegions = process (onRegions, step);
+        boundaries.push_back (step.m_minX);
+        boundaries.push_back (step.m_maxX + 1);
     }
+    std::sort (boundaries.begin (), boundaries.end ());
+    boundaries.erase (std::unique (boundaries.begin (), boundaries.end ()), boundaries.end ());
+
+    std::size_t numSlabs {std::min<std::size_t> (workerCount (), boundaries.size () - 1)};
+    std::vector<int> cuts;
+    for (std::size_t slab {0U}; slab <= numSlabs; ++slab) {
+        cuts.push_back (boundaries[slab * (boundaries.size () - 1) / numSlabs]);
+    }
+
+    std::vector<long long> volumes (numSlabs, 0LL);
+    forEachIndex (numSlabs, [&] (std::size_t slab, unsigned int) {
+        Region bounds {cuts[slab], cuts[slab + 1] - 1, INT_MIN, INT_MAX, INT_MIN, INT_MAX, true};
+        SignedCuboids cuboids;
+        for (Region const& step : clipSteps (steps, bounds)) {
+            cuboids.apply (step);
+        }
+        volumes[slab] = cuboids.volume ();
+    });
+    return std::accumulate (volumes.begin (), volumes.end (), 0LL);
+}
+
+/// \brief Counts the cubes that are on by sweeping over compressed coordinates, for comparison.
+/// Every step boundary splits its axis, so within one (x, y, z) cell of the compressed grid all cubes
+///   share a state.  For each (x, y) column, steps are applied last to first and each z cell is
+///   decided by the first step that reaches it.
+/// \param[in] steps The steps.
+/// \return The number of cubes that are on after all steps.
+long long countOnCubesBySweep (Steps const& steps) {
+    auto compress = [&] (int Region::*low, int Region::*high) {
+        std::vector<int> values;
+        for (Region const& step : steps) {
+            values.push_back (step.*low);
+            values.push_back (step.*high + 1);
+        }
+        std::sort (values.begin (), values.end ());
+        values.erase (std::unique (values.begin (), values.end ()), values.end ());
+        return values;
+    };
+    std::vector<int> xs {compress (&Region::m_minX, &Region::m_maxX)};
+    std::vector<int> ys {compress (&Region::m_minY, &Region::m_maxY)};
+    std::vector<int> zs {compress (&Region::m_minZ, &Region::m_maxZ)};
+    auto indexOf = [] (std::vector<int> const& values, int value) {
+        return (std::size_t)(std::lower_bound (values.begin (), values.end (), value) - values.begin ());
+    };
 
-    return addSizes (onRegions);
+    long long total {0LL};
+    // nextUndecided[z] skips over z cells that a later step has already decided.
+    std::vector<std::size_t> nextUndecided (zs.size ());
+    std::function<std::size_t (std::size_t)> findUndecided = [&] (std::size_t z) {
+        if (nextUndecided[z] != z) { nextUndecided[z] = findUndecided (nextUndecided[z]); }
+        return nextUndecided[z];
+    };
+    for (std::size_t x {0U}; x + 1 < xs.size (); ++x) {
+        std::vector<Region const*> coveringX;
+        for (auto it = steps.rbegin (); it != steps.rend (); ++it) {
+            if (it->m_minX <= xs[x] && xs[x] <= it->m_maxX) { coveringX.push_back (&*it); }
+        }
+        for (std::size_t y {0U}; y + 1 < ys.size (); ++y) {
+            std::iota (nextUndecided.begin (), nextUndecided.end (), 0U);
+            long long length {0LL};
+            for (Region const* step : coveringX) {
+                if (step->m_minY > ys[y] || ys[y] > step->m_maxY) { continue; }
+                std::size_t end {indexOf (zs, step->m_maxZ + 1)};
+                for (std::size_t z {findUndecided (indexOf (zs, step->m_minZ))}; z < end; z = findUndecided (z)) {
+                    if (step->m_on) { length += zs[z + 1] - zs[z]; }
+                    nextUndecided[z] = z + 1;
+                }
+            }
+            total += length * (long long)(xs[x + 1] - xs[x]) * (long long)(ys[y + 1] - ys[y]);
+        }
+    }
+    return total;
 }
 
 /// \brief Runs the program.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The command-line arguments; pass --sweep to also check against the compressed sweep.
 /// \return Always 0.
-int main () {
+int main (int argc, char* argv[]) {
     Steps steps = getInput ();
-    std::cout << part1BruteForce (steps) << "\n";
-    std::cout << part2Dos (steps) << "\n";
+    std::cout << countOnCubes (clipSteps (steps, {-50, 50, -50, 50, -50, 50, true})) << "\n";
+    long long total {countOnCubes (steps)};
+    std::cout << total << "\n";
+    if (argc > 1 && std::string (argv[1]) == "--sweep") {
+        long long swept {countOnCubesBySweep (steps)};
+        std::cout << swept << (swept == total ? " (sweep agrees)" : " (sweep DISAGREES)") << "\n";
+    }
     return 0;
 }
\ No newline at end of file
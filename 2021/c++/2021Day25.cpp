@@ -7,8 +7,11 @@
 #include <vector>
 #include <cassert>
 #include <unordered_set>
+#include <random>
+#include <cstring>
 
 #include "utilities.hpp"
+#include "bitboard.hpp"
 
 constexpr char EAST = '>';
 constexpr char SOUTH = 'v';
@@ -93,10 +96,109 @@ unsigned int iterateUntilStop (Map const& initial) {
     }
 }
 
+/// Both herds of sea cucumbers as bitboards on a torus, so that a whole herd moves with a few operations on
+///   64 cells at a time.
+class HerdBitboards {
+public:
+    /// \brief Constructs an empty sea floor.
+    /// \param[in] rows The number of rows.
+    /// \param[in] cols The number of columns.
+    HerdBitboards (std::size_t rows, std::size_t cols)
+        : m_east (rows, cols), m_south (rows, cols), m_free (rows, cols), m_movers (rows, cols), m_moved (rows, cols) {}
+
+    /// \brief Constructs the sea floor from a map.
+    /// \param[in] map The map.
+    HerdBitboards (Map const& map)
+        : HerdBitboards (map.size (), map.empty () ? 0U : map.front ().size ()) {
+        for (std::size_t row {0U}; row < map.size (); ++row) {
+            for (std::size_t col {0U}; col < map[row].size (); ++col) {
+                set (row, col, map[row][col]);
+            }
+        }
+    }
+
+    /// \brief Puts something in one place on the sea floor.
+    /// \param[in] row The row.
+    /// \param[in] col The column.
+    /// \param[in] c EAST, SOUTH or BLANK.
+    void set (std::size_t row, std::size_t col, char c) {
+        m_east.set (row, col, c == EAST);
+        m_south.set (row, col, c == SOUTH);
+    }
+
+    /// \brief Moves the east-facing herd and then the south-facing herd.
+    /// \return The number of sea cucumbers that moved.
+    std::size_t doStep () {
+        return moveHerd (m_east, 0, 1) + moveHerd (m_south, 1, 0);
+    }
+
+private:
+    /// \brief Moves every member of a herd that has an empty space in front of it.
+    /// \param[inout] herd The herd.
+    /// \param[in] rowStep How far down the herd moves.
+    /// \param[in] colStep How far right the herd moves.
+    /// \return The number of sea cucumbers that moved.
+    std::size_t moveHerd (Bitboard & herd, int rowStep, int colStep) {
+        m_moved = m_east;
+        m_moved |= m_south;
+        m_moved.invert ();
+        // Line each space up with whoever is behind it: that sea cucumber can move into it if it is free.
+        m_moved.shiftInto (m_free, -rowStep, -colStep, true);
+        m_movers = herd;
+        m_movers &= m_free;
+        herd.andNot (m_movers);
+        m_movers.shiftInto (m_moved, rowStep, colStep, true);
+        herd |= m_moved;
+        return m_movers.count ();
+    }
+
+    Bitboard m_east;
+    Bitboard m_south;
+    Bitboard m_free;
+    Bitboard m_movers;
+    Bitboard m_moved;
+};
+
+/// \brief Runs the bitboard simulation until nothing moves.
+/// \param[in] initial The starting map.
+/// \return The first step on which nothing moved.
+unsigned int iterateUntilStop (HerdBitboards herds) {
+    unsigned int iteration {1U};
+    while (herds.doStep () != 0U) {
+        ++iteration;
+    }
+    return iteration;
+}
+
+/// \brief Times the bitboard simulation on a large random sea floor.
+/// \param[in] rows The number of rows.
+/// \param[in] cols The number of columns.
+/// \param[in] steps How many steps to run.
+void benchmark (std::size_t rows, std::size_t cols, unsigned int steps) {
+    HerdBitboards herds (rows, cols);
+    std::mt19937_64 generator {2021U};
+    std::uniform_int_distribution<unsigned int> contents {0U, 2U};
+    char const choices[] {EAST, SOUTH, BLANK};
+    for (std::size_t row {0U}; row < rows; ++row) {
+        for (std::size_t col {0U}; col < cols; ++col) {
+            herds.set (row, col, choices[contents (generator)]);
+        }
+    }
+    std::size_t moves {0U};
+    double rate = measureStepsPerSecond (steps, [&] () { moves += herds.doStep (); });
+    std::cout << moves << " moves at " << rate << " steps/sec\n";
+}
+
 /// \brief Runs the program.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv Optionally --benchmark followed by rows, columns and steps, to time a big random sea floor instead.
 /// \return Always 0.
-int main () {
+int main (int argc, char* argv[]) {
+    if (argc > 4 && std::strcmp (argv[1], "--benchmark") == 0) {
+        benchmark (std::stoul (argv[2]), std::stoul (argv[3]), std::stoul (argv[4]));
+        return 0;
+    }
     Map initial = getInput ();
-    std::cout << iterateUntilStop (initial) << "\n";
+    std::cout << iterateUntilStop (HerdBitboards (initial)) << "\n";
     return 0;
 }
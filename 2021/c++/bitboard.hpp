@@ -0,0 +1,181 @@
+#ifndef AOC_2021_BITBOARD_HPP
+#define AOC_2021_BITBOARD_HPP
+/// \file bitboard.hpp
+/// \author Chad Hogg
+/// \brief A header-only library for cellular automata on bit-packed grids.
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+
+/// A rectangular grid of bits, packed 64 columns to a word with column c of each row in bit c % 64 of word c / 64.
+/// Bits past the last column are always zero.
+class Bitboard {
+public:
+    /// \brief Constructs a board with every bit clear.
+    /// \param[in] rows The number of rows.
+    /// \param[in] cols The number of columns.
+    Bitboard (std::size_t rows, std::size_t cols)
+        : m_rows {rows},
+          m_cols {cols},
+          m_words {(cols + 63U) / 64U},
+          m_lastMask {cols % 64U == 0U ? ~0ULL : (1ULL << (cols % 64U)) - 1ULL},
+          m_bits (rows * m_words, 0ULL) {}
+
+    std::size_t rows () const { return m_rows; }
+    std::size_t cols () const { return m_cols; }
+    std::size_t wordsPerRow () const { return m_words; }
+
+    /// \brief Gets the words of a row.
+    /// \param[in] row The row.
+    /// \return A pointer to its first word.
+    std::uint64_t* row (std::size_t row) { return &m_bits[row * m_words]; }
+    std::uint64_t const* row (std::size_t row) const { return &m_bits[row * m_words]; }
+
+    bool get (std::size_t row, std::size_t col) const {
+        return (m_bits[row * m_words + col / 64U] >> (col % 64U)) & 1ULL;
+    }
+
+    void set (std::size_t row, std::size_t col, bool value) {
+        std::uint64_t& word {m_bits[row * m_words + col / 64U]};
+        std::uint64_t const bit {1ULL << (col % 64U)};
+        word = value ? (word | bit) : (word & ~bit);
+    }
+
+    /// \brief Counts the set bits.
+    /// \return The number of set bits.
+    std::size_t count () const {
+        std::size_t total {0U};
+        for (std::uint64_t word : m_bits) { total += __builtin_popcountll (word); }
+        return total;
+    }
+
+    /// \brief Checks whether any bit is set.
+    /// \return True if at least one bit is set.
+    bool any () const {
+        return std::any_of (m_bits.begin (), m_bits.end (), [] (std::uint64_t word) { return word != 0ULL; });
+    }
+
+    /// \brief Clears every bit.
+    void clear () { std::fill (m_bits.begin (), m_bits.end (), 0ULL); }
+
+    Bitboard& operator&= (Bitboard const& other) { return combine (other, [] (std::uint64_t a, std::uint64_t b) { return a & b; }); }
+    Bitboard& operator|= (Bitboard const& other) { return combine (other, [] (std::uint64_t a, std::uint64_t b) { return a | b; }); }
+    Bitboard& operator^= (Bitboard const& other) { return combine (other, [] (std::uint64_t a, std::uint64_t b) { return a ^ b; }); }
+
+    /// \brief Clears every bit that is set in another board.
+    /// \param[in] other A board of the same size.
+    /// \return This board.
+    Bitboard& andNot (Bitboard const& other) { return combine (other, [] (std::uint64_t a, std::uint64_t b) { return a & ~b; }); }
+
+    /// \brief Flips every bit on the board.
+    /// \return This board.
+    Bitboard& invert () {
+        for (std::size_t r {0U}; r < m_rows; ++r) {
+            std::uint64_t* words {row (r)};
+            for (std::size_t w {0U}; w < m_words; ++w) { words[w] = ~words[w]; }
+            words[m_words - 1U] &= m_lastMask;
+        }
+        return *this;
+    }
+
+    bool operator== (Bitboard const& other) const {
+        return m_rows == other.m_rows && m_cols == other.m_cols && m_bits == other.m_bits;
+    }
+
+    /// \brief Moves every bit of this board some distance, writing the result to another board.
+    /// After this, dest.get (r, c) == get (r - rowStep, c - colStep), either wrapping around the edges of the board
+    ///   or treating everything beyond them as clear.
+    /// \param[out] dest A board of the same size.
+    /// \param[in] rowStep How far to move down: -1, 0, or 1.
+    /// \param[in] colStep How far to move right: -1, 0, or 1.
+    /// \param[in] wrap True if the board is a torus.
+    void shiftInto (Bitboard& dest, int rowStep, int colStep, bool wrap) const {
+        assert (&dest != this && dest.m_rows == m_rows && dest.m_cols == m_cols);
+        assert (rowStep >= -1 && rowStep <= 1 && colStep >= -1 && colStep <= 1);
+        for (std::size_t r {0U}; r < m_rows; ++r) {
+            std::uint64_t* out {dest.row (r)};
+            std::size_t source {(r + m_rows - rowStep) % m_rows};
+            bool offEdge {(rowStep == 1 && r == 0U) || (rowStep == -1 && r == m_rows - 1U)};
+            if (offEdge && !wrap) {
+                std::fill (out, out + m_words, 0ULL);
+                continue;
+            }
+            std::uint64_t const* in {row (source)};
+            if (colStep == 0) {
+                std::copy (in, in + m_words, out);
+            }
+            else if (colStep == 1) {
+                std::uint64_t carry {wrap ? (in[(m_cols - 1U) / 64U] >> ((m_cols - 1U) % 64U)) & 1ULL : 0ULL};
+                for (std::size_t w {0U}; w < m_words; ++w) {
+                    out[w] = (in[w] << 1) | carry;
+                    carry = in[w] >> 63;
+                }
+                out[m_words - 1U] &= m_lastMask;
+            }
+            else {
+                for (std::size_t w {0U}; w + 1U < m_words; ++w) {
+                    out[w] = (in[w] >> 1) | (in[w + 1U] << 63);
+                }
+                std::uint64_t wrapped {wrap ? (in[0] & 1ULL) << ((m_cols - 1U) % 64U) : 0ULL};
+                out[m_words - 1U] = (in[m_words - 1U] >> 1) | wrapped;
+            }
+        }
+    }
+
+private:
+    template<typename Op>
+    Bitboard& combine (Bitboard const& other, Op op) {
+        assert (other.m_rows == m_rows && other.m_cols == m_cols);
+        for (std::size_t index {0U}; index < m_bits.size (); ++index) {
+            m_bits[index] = op (m_bits[index], other.m_bits[index]);
+        }
+        return *this;
+    }
+
+    std::size_t m_rows;
+    std::size_t m_cols;
+    std::size_t m_words;
+    std::uint64_t m_lastMask;
+    std::vector<std::uint64_t> m_bits;
+};
+
+/// A number in every cell of a grid, stored as one bitboard per binary digit (least significant first),
+///   so that arithmetic happens on 64 cells at a time.
+using BitSlicedCounter = std::vector<Bitboard>;
+
+/// \brief Adds one to a counter in every cell where a board is set.
+/// \param[inout] counter The counter, which must have enough planes that nothing overflows.
+/// \param[in] addend Which cells to add one to.
+/// \param[inout] carry Scratch space the same size as the boards.
+/// \param[inout] scratch More scratch space the same size as the boards.
+inline void addOne (BitSlicedCounter& counter, Bitboard const& addend, Bitboard& carry, Bitboard& scratch) {
+    carry = addend;
+    for (Bitboard& plane : counter) {
+        if (!carry.any ()) { return; }
+        scratch = plane;
+        scratch &= carry;
+        plane ^= carry;
+        std::swap (carry, scratch);
+    }
+    assert (!carry.any () && "bit-sliced counter overflowed");
+}
+
+/// \brief Times some number of steps of an automaton.
+/// \param[in] steps How many steps to run.
+/// \param[in] step A function that runs one step.
+/// \return The number of steps per second.
+template<typename Step>
+double measureStepsPerSecond (unsigned int steps, Step step) {
+    auto start = std::chrono::steady_clock::now ();
+    for (unsigned int count {0U}; count < steps; ++count) {
+        step ();
+    }
+    std::chrono::duration<double> elapsed {std::chrono::steady_clock::now () - start};
+    return steps / elapsed.count ();
+}
+
+#endif//AOC_2021_BITBOARD_HPP
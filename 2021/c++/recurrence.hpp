@@ -0,0 +1,143 @@
+#ifndef AOC_2021_RECURRENCE_HPP
+#define AOC_2021_RECURRENCE_HPP
+/// \file recurrence.hpp
+/// \author Chad Hogg
+/// \brief A header-only library for linear recurrences over counts, like populations that evolve by fixed rules.
+
+#include <vector>
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <utility>
+
+/// A linear recurrence on a fixed-size vector of counts: every step, each entry sends some multiple of its
+///   count to some set of entries, and the next vector is the sum of everything sent.
+/// All arithmetic can be done modulo some number; a modulus of 0 means ordinary unsigned (mod 2^64) arithmetic.
+class LinearRecurrence {
+public:
+    using Count = unsigned long long;
+    using State = std::vector<Count>;
+
+    /// \brief Constructs a recurrence in which nothing is sent anywhere.
+    /// \param[in] size The number of entries in the state vector.
+    LinearRecurrence (std::size_t size) : m_size {size}, m_transitions {} {}
+
+    /// \brief Adds to the recurrence.
+    /// \param[in] from The entry that sends some of its count.
+    /// \param[in] to The entry that receives it.
+    /// \param[in] times How many times the count of from is added to to.
+    void addTransition (std::size_t from, std::size_t to, Count times = 1ULL) {
+        assert (from < m_size && to < m_size);
+        m_transitions.push_back ({from, to, times});
+    }
+
+    /// \brief Gets the number of entries in the state vector.
+    /// \return The size of the state vector.
+    std::size_t size () const { return m_size; }
+
+    /// \brief Runs the recurrence forward, choosing whichever of stepping and repeated squaring is cheaper.
+    /// \param[in] state The starting state.
+    /// \param[in] steps How many steps to run.
+    /// \param[in] modulus What to reduce counts modulo, or 0 for none.
+    /// \return The state after that many steps.
+    State advance (State const& state, unsigned long long steps, Count modulus = 0ULL) const {
+        unsigned long long bits {0ULL};
+        for (unsigned long long remaining {steps}; remaining != 0ULL; remaining >>= 1) { ++bits; }
+        if (m_transitions.empty () || steps <= bits * m_size * m_size * m_size / m_transitions.size ()) {
+            return step (state, steps, modulus);
+        }
+        return square (state, steps, modulus);
+    }
+
+    /// \brief Runs the recurrence forward one step at a time, in time linear in the number of steps.
+    /// \param[in] state The starting state.
+    /// \param[in] steps How many steps to run.
+    /// \param[in] modulus What to reduce counts modulo, or 0 for none.
+    /// \return The state after that many steps.
+    State step (State const& state, unsigned long long steps, Count modulus = 0ULL) const {
+        assert (state.size () == m_size);
+        State current {reduce (state, modulus)};
+        State next (m_size);
+        for (unsigned long long time {0ULL}; time < steps; ++time) {
+            std::fill (next.begin (), next.end (), 0ULL);
+            for (Transition const& transition : m_transitions) {
+                next[transition.to] = add (next[transition.to], multiply (transition.times, current[transition.from], modulus), modulus);
+            }
+            std::swap (current, next);
+        }
+        return current;
+    }
+
+    /// \brief Runs the recurrence forward by repeated squaring of its matrix, in time logarithmic in the number of steps.
+    /// \param[in] state The starting state.
+    /// \param[in] steps How many steps to run.
+    /// \param[in] modulus What to reduce counts modulo, or 0 for none.
+    /// \return The state after that many steps.
+    State square (State const& state, unsigned long long steps, Count modulus = 0ULL) const {
+        assert (state.size () == m_size);
+        State current {reduce (state, modulus)};
+        // Dense and row-major: power[to * m_size + from] is how much of from ends up in to.
+        std::vector<Count> power (m_size * m_size, 0ULL);
+        for (Transition const& transition : m_transitions) {
+            Count& entry {power[transition.to * m_size + transition.from]};
+            entry = add (entry, reduce (transition.times, modulus), modulus);
+        }
+        while (steps != 0ULL) {
+            if (steps & 1ULL) {
+                current = multiply (power, current, modulus);
+            }
+            steps >>= 1;
+            if (steps != 0ULL) {
+                power = multiply (power, power, modulus);
+            }
+        }
+        return current;
+    }
+
+private:
+    struct Transition {
+        std::size_t from;
+        std::size_t to;
+        Count times;
+    };
+
+    static Count reduce (Count value, Count modulus) {
+        return modulus == 0ULL ? value : value % modulus;
+    }
+
+    static State reduce (State const& state, Count modulus) {
+        State result {state};
+        for (Count& value : result) { value = reduce (value, modulus); }
+        return result;
+    }
+
+    static Count add (Count a, Count b, Count modulus) {
+        return modulus == 0ULL ? a + b : (Count)(((unsigned __int128)a + b) % modulus);
+    }
+
+    static Count multiply (Count a, Count b, Count modulus) {
+        return modulus == 0ULL ? a * b : (Count)(((unsigned __int128)a * b) % modulus);
+    }
+
+    /// \brief Multiplies a square matrix by a vector, or by another square matrix.
+    std::vector<Count> multiply (std::vector<Count> const& matrix, std::vector<Count> const& other, Count modulus) const {
+        std::size_t columns {other.size () / m_size};
+        std::vector<Count> result (other.size (), 0ULL);
+        for (std::size_t row {0U}; row < m_size; ++row) {
+            for (std::size_t middle {0U}; middle < m_size; ++middle) {
+                Count scale {matrix[row * m_size + middle]};
+                if (scale == 0ULL) { continue; }
+                for (std::size_t column {0U}; column < columns; ++column) {
+                    Count& entry {result[row * columns + column]};
+                    entry = add (entry, multiply (scale, other[middle * columns + column], modulus), modulus);
+                }
+            }
+        }
+        return result;
+    }
+
+    std::size_t m_size;
+    std::vector<Transition> m_transitions;
+};
+
+#endif//AOC_2021_RECURRENCE_HPP
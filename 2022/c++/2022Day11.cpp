@@ -8,6 +8,12 @@
 #include <cassert>
 #include <list>
 #include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <cstdint>
+#include <cstdlib>
+
+#include "utilities.hpp"
 
 using Worry = unsigned long;
 
@@ -99,85 +105,187 @@ getInput ()
   return monkeys;
 }
 
-Worry
-applyOperation (Worry old, const std::string& rater, const std::string& operand)
+// A monkey's operation, worked out once instead of on every inspection.
+enum class OperationKind { ADD, MULTIPLY, SQUARE };
+
+struct Operation
+{
+  OperationKind kind;
+  Worry operand;
+
+  Worry
+  apply (Worry old) const
+  {
+    switch (kind)
+    {
+    case OperationKind::ADD: return old + operand;
+    case OperationKind::MULTIPLY: return old * operand;
+    default: return old * old;
+    }
+  }
+};
+
+Operation
+compileOperation (const std::string& rater, const std::string& operand)
 {
   assert (rater == "+" || rater == "*");
-  if (rater == "+")
+  if (operand == "old")
   {
-    if (operand == "old") { return old + old; }
-    else { return old + atoi (operand.c_str ()); }
+    // old + old is the same as old * 2.
+    return rater == "+" ? Operation {OperationKind::MULTIPLY, 2} : Operation {OperationKind::SQUARE, 0};
   }
-  else
+  Worry value = atoi (operand.c_str ());
+  return {rater == "+" ? OperationKind::ADD : OperationKind::MULTIPLY, value};
+}
+
+struct CompiledMonkey
+{
+  Operation operation;
+  Worry test;
+  std::size_t trueThrow;
+  std::size_t falseThrow;
+};
+
+// Everything about the monkeys except who is holding what.
+// What matters to determine where an item goes is whether or not it is divisible
+//   by each monkey's test.  Modding by the product of each of those won't change
+//   the answer.  This prevents worry levels from growing infinitely.
+struct Troop
+{
+  std::vector<CompiledMonkey> monkeys;
+  Worry relief;
+  Worry divisorProd;
+};
+
+Troop
+compileTroop (const std::vector<Monkey>& monkeys, Worry relief)
+{
+  Troop troop {{}, relief, 1};
+  for (const Monkey& monk : monkeys)
   {
-    if (operand == "old") { return old * old; }
-    else { return old * atoi (operand.c_str ()); }
+    troop.monkeys.push_back ({compileOperation (monk.oper, monk.operand), (Worry)monk.test, (std::size_t)monk.trueThrow, (std::size_t)monk.falseThrow});
+    troop.divisorProd *= monk.test;
   }
+  return troop;
+}
+
+// Where an item is at the start of a round.
+struct ItemState
+{
+  std::size_t monkey;
+  Worry worry;
+
+  bool operator== (const ItemState& other) const { return monkey == other.monkey && worry == other.worry; }
+};
+
+using Counts = std::vector<unsigned long long>;
+
+// Takes an item through one round, counting its inspections.
+// Monkeys take turns in order, so an item thrown to a later monkey is inspected again this round.
+ItemState
+advanceItem (const Troop& troop, ItemState item, Counts& inspected)
+{
+  std::size_t previous;
+  do
+  {
+    const CompiledMonkey& monk = troop.monkeys[item.monkey];
+    ++inspected[item.monkey];
+    item.worry = monk.operation.apply (item.worry) / troop.relief % troop.divisorProd;
+    previous = item.monkey;
+    item.monkey = item.worry % monk.test == 0 ? monk.trueThrow : monk.falseThrow;
+  } while (item.monkey > previous);
+  return item;
 }
 
-std::vector<unsigned long>
-doRound (std::vector<Monkey>& monkeys, const Worry RELIEF, const Worry DIVISOR_PROD)
+// How many times each monkey inspects one item over some number of rounds.
+// How an item moves depends only on where it is and how worried we are about it, of which there are finitely
+//   many combinations, so it eventually goes around a cycle; once that shows up, whole cycles are skipped at once.
+Counts
+followItem (const Troop& troop, ItemState item, unsigned long long rounds)
 {
-  std::vector<unsigned long> amountInspected;
-  for (std::size_t activeIndex = 0; activeIndex < monkeys.size (); ++activeIndex)
+  const std::size_t monkeys = troop.monkeys.size ();
+  std::unordered_map<std::uint64_t, unsigned long long> firstSeen;
+  // The total counts after each round, one block of monkeys counts per round.
+  Counts history (monkeys, 0);
+  Counts inspected (monkeys, 0);
+  for (unsigned long long round = 0; round < rounds; ++round)
   {
-    Monkey& monk = monkeys[activeIndex];
-    amountInspected.push_back (monk.items.size ());
-    while (!monk.items.empty ())
+    std::uint64_t key = item.worry * monkeys + item.monkey;
+    auto [found, fresh] = firstSeen.insert ({key, round});
+    if (!fresh)
     {
-      Worry item = monk.items.front ();
-      monk.items.pop_front ();
-      item = applyOperation (item, monk.oper, monk.operand);
-      item /= RELIEF;
-      item %= DIVISOR_PROD;
-      if (item % monk.test == 0)
-      {
-        monkeys[monk.trueThrow].items.push_back (item);
-      }
-      else
+      unsigned long long cycleStart = found->second;
+      unsigned long long cycleLength = round - cycleStart;
+      unsigned long long cycles = (rounds - round) / cycleLength;
+      unsigned long long leftover = (rounds - round) % cycleLength;
+      for (std::size_t monkey = 0; monkey < monkeys; ++monkey)
       {
-        monkeys[monk.falseThrow].items.push_back (item);
+        unsigned long long perCycle = inspected[monkey] - history[cycleStart * monkeys + monkey];
+        unsigned long long partial = history[(cycleStart + leftover) * monkeys + monkey] - history[cycleStart * monkeys + monkey];
+        inspected[monkey] += cycles * perCycle + partial;
       }
+      return inspected;
     }
+    item = advanceItem (troop, item, inspected);
+    history.insert (history.end (), inspected.begin (), inspected.end ());
   }
-  return amountInspected;
+  return inspected;
 }
 
-Worry
-solve (std::vector<Monkey> monkeys, const int RELIEF, const int ROUNDS)
+// Follows every item on its own, spread across threads, and adds up the counts at the end.
+Counts
+countInspections (const Troop& troop, const std::vector<Monkey>& monkeys, unsigned long long rounds)
 {
-  // Explanation:
-  // What matters to determine where an item goes is whether or not it is divisible
-  //   by each monkey's test.  Modding by the product of each of those won't change
-  //   the answer.  This prevents worry levels from growing infinitely.
-  Worry divisorProd = 1;
-  for (const Monkey& monk : monkeys) { divisorProd *= monk.test; }
-  
-  std::vector<unsigned long> activities (monkeys.size (), 0);
-  for (int i = 1; i <= ROUNDS; ++i)
+  std::vector<ItemState> items;
+  for (std::size_t index = 0; index < monkeys.size (); ++index)
   {
-    std::vector<unsigned long> amountInspected = doRound (monkeys, RELIEF, divisorProd);
-    for (std::size_t index = 0; index < monkeys.size (); ++index)
-    {
-      activities[index] += amountInspected[index];
-    }
-    //std::cout << "After round " << i << "\n";
-    //for (std::size_t index = 0; index < monkeys.size (); ++index)
-    //{
-    //  std::cout << "Monkey " << index << " has ";
-    //  for (const auto& x : monkeys[index].items) { std::cout << x << " "; }
-    //  std::cout << "\n";
-    //}
-    //for (auto x : activities) { std::cout << x << " "; } std::cout << "\n";
+    for (Worry worry : monkeys[index].items) { items.push_back ({index, worry}); }
   }
-  //for (auto x : activities) { std::cout << x << " "; } std::cout << "\n";
+  std::vector<Counts> perItem (items.size ());
+  forEachIndex (items.size (), [&] (std::size_t index, unsigned int)
+  {
+    perItem[index] = followItem (troop, items[index], rounds);
+  });
+
+  Counts total (monkeys.size (), 0);
+  for (const Counts& counts : perItem)
+  {
+    for (std::size_t monkey = 0; monkey < total.size (); ++monkey) { total[monkey] += counts[monkey]; }
+  }
+  return total;
+}
+
+// Long runs make the two counts big enough that their product does not fit in 64 bits.
+unsigned __int128
+monkeyBusiness (const std::vector<Monkey>& monkeys, Worry relief, unsigned long long rounds)
+{
+  Counts activities = countInspections (compileTroop (monkeys, relief), monkeys, rounds);
   std::sort (activities.begin (), activities.end ());
-  return activities[monkeys.size () - 2] * activities[monkeys.size () - 1];
+  return (unsigned __int128)activities[activities.size () - 2] * activities[activities.size () - 1];
 }
 
-int main () {
+std::string
+toString (unsigned __int128 value)
+{
+  std::string digits;
+  do
+  {
+    digits.push_back ('0' + (int)(value % 10));
+    value /= 10;
+  } while (value != 0);
+  std::reverse (digits.begin (), digits.end ());
+  return digits;
+}
+
+int
+main (int argc, char* argv[])
+{
   std::vector<Monkey> monkeys = getInput ();
-  std::cout << solve (monkeys, 3, 20) << "\n";
-  std::cout << solve (monkeys, 1, 10000) << "\n";
+  std::cout << toString (monkeyBusiness (monkeys, 3, 20)) << "\n";
+  std::cout << toString (monkeyBusiness (monkeys, 1, 10000)) << "\n";
+  if (argc > 1)
+  {
+    std::cout << toString (monkeyBusiness (monkeys, 1, std::strtoull (argv[1], nullptr, 10))) << "\n";
+  }
   return 0;
 }
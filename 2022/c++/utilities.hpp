@@ -7,6 +7,9 @@
 #include <iostream>
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 /// Reads a value from an input stream, but doesn't tell you whether or not it succeeded.
 /// \param[in] in The stream.
@@ -141,4 +144,36 @@ std::string to_string (std::pair<A, B> const& pair) {
 }
 
 
+/// \brief Decides how many threads a parallel loop should use.
+/// \return The number of hardware threads, or 1 if that is unknown.
+inline unsigned int workerCount () {
+    return std::max (1U, std::thread::hardware_concurrency ());
+}
+
+/// \brief Calls a function once for every index in [0, count), sharing the indices among threads.
+/// Each thread takes the next unclaimed index, so indices that take much longer than others do not hold up the rest.
+/// \param[in] count The number of indices.
+/// \param[in] work The function, called as work (index, thread) where thread is in [0, threads).
+///   Calls with different thread numbers may run at the same time; calls with the same one never do.
+/// \param[in] threads How many threads to use.
+template<typename Work>
+void forEachIndex (std::size_t count, Work work, unsigned int threads = workerCount ()) {
+    std::atomic<std::size_t> next {0U};
+    auto loop = [&] (unsigned int thread) {
+        for (std::size_t index = next++; index < count; index = next++) {
+            work (index, thread);
+        }
+    };
+    if (threads <= 1U || count <= 1U) {
+        loop (0U);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (unsigned int thread {1U}; thread < threads; ++thread) {
+        workers.emplace_back (loop, thread);
+    }
+    loop (0U);
+    for (std::thread& worker : workers) { worker.join (); }
+}
+
 #endif//AOC_2021_UTILITIES_HPP
\ No newline at end of file
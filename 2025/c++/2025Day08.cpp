@@ -6,33 +6,39 @@
 #include <iostream>
 #include <vector>
 #include <cassert>
-#include <set>
 #include <algorithm>
+#include <numeric>
+#include <queue>
+#include <limits>
+#include <tuple>
 
 using Distance = long long;
+const Distance INFINITE_DISTANCE = std::numeric_limits<Distance>::max ();
 
-struct JunctionBox
+// The junction boxes, stored one coordinate per array.
+struct JunctionBoxes
 {
-  int x;
-  int y;
-  int z;
-  auto operator<=> (const JunctionBox& other) const = default;
-};
+  std::vector<int> x;
+  std::vector<int> y;
+  std::vector<int> z;
 
-using Circuit = std::set<JunctionBox>;
+  std::size_t size () const { return x.size (); }
 
-Distance
-squaredDistance (const JunctionBox& p1, const JunctionBox& p2)
-{
-  Distance x = (p1.x - p2.x);
-  Distance y = (p1.y - p2.y);
-  Distance z = (p1.z - p2.z);
-  return x*x + y*y + z*z;
-}
+  int coordinate (std::size_t box, std::size_t axis) const {
+    if (axis == 0) { return x[box]; }
+    else if (axis == 1) { return y[box]; }
+    else { return z[box]; }
+  }
+
+  Distance squaredDistance (std::size_t box1, std::size_t box2) const {
+    Distance dx = x[box1] - x[box2];
+    Distance dy = y[box1] - y[box2];
+    Distance dz = z[box1] - z[box2];
+    return dx*dx + dy*dy + dz*dz;
+  }
+};
 
-// In retrospect, I should have just had a collection of junction boxes.
-// Not bothering to change it now.
-using Problem = std::vector<Circuit>;
+using Problem = JunctionBoxes;
 
 Problem
 getInput ()
@@ -40,131 +46,242 @@ getInput ()
   Problem prob;
   int x, y, z;
   while (scanf ("%d,%d,%d", &x, &y, &z) == 3) {
-    prob.push_back ({{x, y, z}});
+    prob.x.push_back (x);
+    prob.y.push_back (y);
+    prob.z.push_back (z);
   }
   return prob;
 }
 
-using Edge = std::pair<JunctionBox, JunctionBox>;
+// A pair of junction box indices, smaller first.
+using Edge = std::pair<std::size_t, std::size_t>;
 
-std::vector<Edge>
-makeMinimumConnections (const Problem& prob, std::size_t count)
+// A disjoint-set forest of circuits, using path compression and union by size.
+class Circuits
 {
-  std::vector<Edge> edges;
-  std::set<std::pair<Distance, Edge>> possibleEdges;
-  for (auto it = prob.begin (); it != prob.end (); ++it) {
-    for (auto it2 = it + 1; it2 != prob.end (); ++it2) {
-      possibleEdges.insert ({squaredDistance (*it->begin (), *it2->begin ()), {*it->begin (), *it2->begin ()}});
+public:
+  Circuits (std::size_t count)
+    : m_parents (count), m_sizes (count, 1), m_count {count}
+  {
+    std::iota (m_parents.begin (), m_parents.end (), 0);
+  }
+
+  std::size_t
+  find (std::size_t box)
+  {
+    std::size_t root = box;
+    while (m_parents[root] != root) { root = m_parents[root]; }
+    while (m_parents[box] != root) {
+      std::size_t next = m_parents[box];
+      m_parents[box] = root;
+      box = next;
     }
+    return root;
+  }
+
+  // Returns false if they were already in the same circuit.
+  bool
+  connect (std::size_t box1, std::size_t box2)
+  {
+    std::size_t root1 = find (box1);
+    std::size_t root2 = find (box2);
+    if (root1 == root2) { return false; }
+    if (m_sizes[root1] < m_sizes[root2]) { std::swap (root1, root2); }
+    m_parents[root2] = root1;
+    m_sizes[root1] += m_sizes[root2];
+    --m_count;
+    return true;
   }
-  while (edges.size () < count) {
-    edges.push_back (possibleEdges.begin ()->second);
-    possibleEdges.erase (possibleEdges.begin ());
+
+  std::size_t count () const { return m_count; }
+
+  std::vector<std::size_t>
+  sizes ()
+  {
+    std::vector<std::size_t> result;
+    for (std::size_t box = 0; box < m_parents.size (); ++box) {
+      if (find (box) == box) { result.push_back (m_sizes[box]); }
+    }
+    return result;
   }
-  return edges;
-}
 
-std::vector<Circuit>
-getConnectedComponents (const Problem& prob, std::vector<Edge> edges)
+private:
+  std::vector<std::size_t> m_parents;
+  std::vector<std::size_t> m_sizes;
+  std::size_t m_count;
+};
+
+// A k-d tree stored implicitly: every subrange of m_order has its splitting box at its midpoint,
+//   with smaller coordinates (on that level's axis) before it and larger ones after.
+class KdTree
 {
-  std::vector<Circuit> circuits;
-  std::set<JunctionBox> todo;
-  for (const Circuit& thing : prob) {
-    for (const JunctionBox& thing2 : thing) {
-      todo.insert (thing2);
-    }
+public:
+  KdTree (const JunctionBoxes& boxes)
+    : m_boxes {boxes}, m_order (boxes.size ())
+  {
+    std::iota (m_order.begin (), m_order.end (), 0);
+    build (0, m_order.size (), 0);
   }
-  while (!todo.empty ()) {
-    Circuit explored, frontier;
-    frontier.insert (*todo.begin ());
-    todo.erase (todo.begin ());
-    while (!frontier.empty ()) {
-      JunctionBox current = *frontier.begin ();
-      frontier.erase (current);
-      for (const Edge& edge : edges) {
-        if (edge.first == current) {
-          if (todo.count (edge.second) != 0) {
-            frontier.insert (edge.second);
-            todo.erase (edge.second);
-          }
-        }
-        else if (edge.second == current) {
-          if (todo.count (edge.first) != 0) {
-            frontier.insert (edge.first);
-            todo.erase (edge.first);
-          }
-        }
-      }
-      explored.insert (current);
+
+  // Calls visit (box, squaredDistance) on every box that might be closer to query than bound, which
+  //   visit may shrink as it goes.  Skips any subrange [low, high) for which skip (low, high) is true.
+  template<typename Skip, typename Visit>
+  void
+  search (std::size_t query, const Distance& bound, Skip skip, Visit visit) const
+  {
+    search (query, bound, skip, visit, 0, m_order.size (), 0);
+  }
+
+  std::size_t size () const { return m_order.size (); }
+
+  std::size_t boxAt (std::size_t position) const { return m_order[position]; }
+
+private:
+  void
+  build (std::size_t low, std::size_t high, std::size_t axis)
+  {
+    if (high - low <= 1) { return; }
+    std::size_t mid = low + (high - low) / 2;
+    std::nth_element (m_order.begin () + low, m_order.begin () + mid, m_order.begin () + high,
+                      [&] (std::size_t a, std::size_t b) {
+                        return m_boxes.coordinate (a, axis) < m_boxes.coordinate (b, axis);
+                      });
+    build (low, mid, (axis + 1) % 3);
+    build (mid + 1, high, (axis + 1) % 3);
+  }
+
+  template<typename Skip, typename Visit>
+  void
+  search (std::size_t query, const Distance& bound, Skip& skip, Visit& visit,
+          std::size_t low, std::size_t high, std::size_t axis) const
+  {
+    if (low >= high || skip (low, high)) { return; }
+    std::size_t mid = low + (high - low) / 2;
+    std::size_t box = m_order[mid];
+    visit (box, m_boxes.squaredDistance (query, box));
+    Distance offset = m_boxes.coordinate (query, axis) - m_boxes.coordinate (box, axis);
+    std::size_t nextAxis = (axis + 1) % 3;
+    if (offset < 0) {
+      search (query, bound, skip, visit, low, mid, nextAxis);
+      if (offset * offset < bound) { search (query, bound, skip, visit, mid + 1, high, nextAxis); }
+    }
+    else {
+      search (query, bound, skip, visit, mid + 1, high, nextAxis);
+      if (offset * offset < bound) { search (query, bound, skip, visit, low, mid, nextAxis); }
     }
-    circuits.push_back (explored);
   }
-  return circuits;
-}
 
-bool
-componentSizeLess (const Circuit& c1, const Circuit& c2)
+  const JunctionBoxes& m_boxes;
+  std::vector<std::size_t> m_order;
+};
+
+// The count shortest possible cables, shortest first.
+std::vector<Edge>
+makeMinimumConnections (const Problem& prob, const KdTree& tree, std::size_t count)
 {
-  return c1.size () < c2.size ();
+  // A max-heap of the shortest cables seen so far, so the longest of them is easy to evict.
+  using Candidate = std::tuple<Distance, std::size_t, std::size_t>;
+  std::priority_queue<Candidate> shortest;
+  Distance bound = INFINITE_DISTANCE;
+  auto never = [] (std::size_t, std::size_t) { return false; };
+  for (std::size_t box = 0; box < prob.size (); ++box) {
+    tree.search (box, bound, never, [&] (std::size_t other, Distance distance) {
+      if (other <= box || distance >= bound) { return; }
+      shortest.push ({distance, box, other});
+      if (shortest.size () > count) { shortest.pop (); }
+      if (shortest.size () == count) { bound = std::get<0> (shortest.top ()); }
+    });
+  }
+  std::vector<Edge> edges (shortest.size ());
+  for (std::size_t index = edges.size (); index-- > 0;) {
+    edges[index] = {std::get<1> (shortest.top ()), std::get<2> (shortest.top ())};
+    shortest.pop ();
+  }
+  return edges;
 }
 
 std::size_t
-multiplySizes (std::vector<Circuit>& components)
+multiplySizes (const Problem& prob, const std::vector<Edge>& edges)
 {
-  std::sort (components.begin (), components.end (), componentSizeLess);
-  return components.at (components.size () - 1).size () * components.at (components.size () - 2).size () * components.at (components.size () - 3).size ();
+  Circuits circuits (prob.size ());
+  for (const Edge& edge : edges) {
+    circuits.connect (edge.first, edge.second);
+  }
+  std::vector<std::size_t> sizes = circuits.sizes ();
+  assert (sizes.size () >= 3);
+  std::partial_sort (sizes.begin (), sizes.begin () + 3, sizes.end (), std::greater<std::size_t> ());
+  return sizes[0] * sizes[1] * sizes[2];
 }
 
+// The last cable Kruskal's algorithm would add is the longest one in the minimum spanning tree, so
+//   build that tree with Boruvka's algorithm: each round, every circuit finds its nearest outside box.
 Distance
-connectAll (const Problem& prob)
+connectAll (const Problem& prob, const KdTree& tree)
 {
-  // Get all possible cables, sorted from shortest to longest.
-  std::set<std::pair<Distance, Edge>> possibleEdges;
-  for (auto it = prob.begin (); it != prob.end (); ++it) {
-    for (auto it2 = it + 1; it2 != prob.end (); ++it2) {
-      possibleEdges.insert ({squaredDistance (*it->begin (), *it2->begin ()), {*it->begin (), *it2->begin ()}});
-    }
-  }
+  const std::size_t MIXED = std::numeric_limits<std::size_t>::max ();
+  const std::size_t EMPTY = MIXED - 1;
+  Circuits circuits (prob.size ());
+  std::vector<std::size_t> circuitOf (prob.size ());
+  // For each subrange of the tree, keyed by its midpoint, the circuit all of its boxes are in (or MIXED).
+  std::vector<std::size_t> subtreeCircuit (tree.size ());
+  Edge longest {0, 0};
+  Distance longestDistance = -1;
 
-  // Make a vector of initially-unary circuits.
-  std::vector<Circuit> circuits;
-  for (auto it = prob.begin (); it != prob.end (); ++it) {
-    circuits.push_back ({*it});
-  }
+  while (circuits.count () > 1) {
+    for (std::size_t box = 0; box < prob.size (); ++box) { circuitOf[box] = circuits.find (box); }
+    auto label = [&] (auto& self, std::size_t low, std::size_t high) -> std::size_t {
+      if (low >= high) { return EMPTY; }
+      std::size_t mid = low + (high - low) / 2;
+      std::size_t mine = circuitOf[tree.boxAt (mid)];
+      std::size_t left = self (self, low, mid);
+      std::size_t right = self (self, mid + 1, high);
+      bool uniform = (left == EMPTY || left == mine) && (right == EMPTY || right == mine);
+      subtreeCircuit[mid] = uniform ? mine : MIXED;
+      return subtreeCircuit[mid];
+    };
+    label (label, 0, tree.size ());
 
-  // Keep track of our answer for the last pair that we connected.
-  Distance mostRecent = 0;
-  // Repeat until finally all junction boxes are in a single circuit.
-  while (circuits.size () > 1) {
-    // Get the first (shortest) un-used cable.
-    std::pair<Distance, Edge> current = *possibleEdges.begin ();
-    possibleEdges.erase (possibleEdges.begin ());
-    mostRecent = current.second.first.x * current.second.second.x;
-    // Go find the circuits containing those junction boxes.
-    std::size_t found1 = 0;
-    std::size_t found2 = 0;
-    for (std::size_t index = 0; index < circuits.size (); ++index) {
-      if (circuits.at (index).count (current.second.first)) { found1 = index; }
-      if (circuits.at (index).count (current.second.second)) { found2 = index; }
+    std::vector<Distance> nearestDistance (prob.size (), INFINITE_DISTANCE);
+    std::vector<Edge> nearestEdge (prob.size ());
+    for (std::size_t box = 0; box < prob.size (); ++box) {
+      std::size_t circuit = circuitOf[box];
+      Distance bound = nearestDistance[circuit];
+      std::size_t found = box;
+      auto insideCircuit = [&] (std::size_t low, std::size_t high) {
+        return subtreeCircuit[low + (high - low) / 2] == circuit;
+      };
+      tree.search (box, bound, insideCircuit, [&] (std::size_t other, Distance distance) {
+        if (circuitOf[other] != circuit && distance < bound) {
+          bound = distance;
+          found = other;
+        }
+      });
+      if (found != box) {
+        nearestDistance[circuit] = bound;
+        nearestEdge[circuit] = {std::min (box, found), std::max (box, found)};
+      }
     }
-    // If the junction boxes are in different circuits, combine them.
-    if (found1 != found2) {
-      circuits[found1].insert (circuits[found2].begin (), circuits[found2].end ());
-      circuits.erase (circuits.begin () + found2);
+
+    for (std::size_t circuit = 0; circuit < prob.size (); ++circuit) {
+      if (nearestDistance[circuit] == INFINITE_DISTANCE) { continue; }
+      const Edge& edge = nearestEdge[circuit];
+      if (circuits.connect (edge.first, edge.second) && nearestDistance[circuit] > longestDistance) {
+        longestDistance = nearestDistance[circuit];
+        longest = edge;
+      }
     }
   }
 
-  return mostRecent;
+  return Distance (prob.x[longest.first]) * prob.x[longest.second];
 }
 
 int
 main (int argc, char* argv[])
 {
   Problem prob = getInput ();
-  std::vector<Edge> edges = makeMinimumConnections (prob, 1000);
-  std::vector<Circuit> components = getConnectedComponents (prob, edges);
-  std::cout << multiplySizes (components) << "\n";
-  std::cout << connectAll (prob) << "\n";
+  KdTree tree (prob);
+  std::vector<Edge> edges = makeMinimumConnections (prob, tree, 1000);
+  std::cout << multiplySizes (prob, edges) << "\n";
+  std::cout << connectAll (prob, tree) << "\n";
   return EXIT_SUCCESS;
 }
-
@@ -11,7 +11,14 @@
 #include <set>
 #include <sstream>
 #include <cstdint>
-#include <z3++.h>
+#include <bit>
+#include <numeric>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "utilities.hpp"
 
 using Lights = std::vector<bool>;
 using Button = std::set<int>;
@@ -162,143 +169,469 @@ configureIndicatorLights (const Machine& machine)
   return {};
 }
 
+
+// The lights are a linear system over GF(2): one row per light, one bit per button, plus the
+//   desired state in the bit after the last button.  A row takes as many words as the buttons need.
+using BitRow = std::vector<std::uint64_t>;
+constexpr std::size_t WORD_BITS = 64;
+
+// Trying every choice of the free buttons doubles with each one, so past this it is hopeless.
+constexpr std::size_t MAX_FREE_BUTTONS = 30;
+
+bool
+testBit (const BitRow& row, std::size_t bit)
+{
+  return (row[bit / WORD_BITS] >> (bit % WORD_BITS)) & 1;
+}
+
+void
+setBit (BitRow& row, std::size_t bit)
+{
+  row[bit / WORD_BITS] |= std::uint64_t (1) << (bit % WORD_BITS);
+}
+
 std::size_t
-part1 (const Problem& prob)
+countCommonBits (const BitRow& row1, const BitRow& row2)
 {
-  std::size_t total = 0;
-  for (const Machine& machine : prob) {
-    total += configureIndicatorLights (machine).size ();
+  std::size_t count = 0;
+  for (std::size_t word = 0; word < row1.size (); ++word) {
+    count += std::popcount (row1[word] & row2[word]);
   }
-  return total;
+  return count;
 }
 
-using NumPresses = std::vector<uint16_t>;
-
-Joltages
-applyPresses (const Machine& machine, const NumPresses& presses)
+std::size_t
+configureIndicatorLightsFast (const Machine& machine)
 {
-  Joltages joltages (machine.joltageRequirements.size (), 0);
-  for (std::size_t buttonNo = 0; buttonNo < presses.size (); ++buttonNo) {
-    const Button& button = machine.buttons.at (buttonNo);
-    for (std::size_t counterNo : button) {
-      joltages[counterNo] += presses[buttonNo];
+  const std::size_t numButtons = machine.buttons.size ();
+  const std::size_t rhsBit = numButtons;
+  const std::size_t numWords = numButtons / WORD_BITS + 1;
+  std::vector<BitRow> rows (machine.desiredIndicators.size (), BitRow (numWords, 0));
+  for (std::size_t buttonNo = 0; buttonNo < numButtons; ++buttonNo) {
+    for (int lightNo : machine.buttons.at (buttonNo)) {
+      setBit (rows.at (lightNo), buttonNo);
     }
   }
-  return joltages;
+  for (std::size_t lightNo = 0; lightNo < rows.size (); ++lightNo) {
+    if (machine.desiredIndicators.at (lightNo)) { setBit (rows[lightNo], rhsBit); }
+  }
+
+  // Gauss-Jordan elimination, remembering which column each pivot row solves for.
+  std::vector<std::size_t> pivotCols;
+  std::vector<std::size_t> freeCols;
+  std::size_t rank = 0;
+  for (std::size_t col = 0; col < numButtons; ++col) {
+    std::size_t pivot = rank;
+    while (pivot < rows.size () && !testBit (rows[pivot], col)) { ++pivot; }
+    if (pivot == rows.size ()) {
+      freeCols.push_back (col);
+      continue;
+    }
+    std::swap (rows[rank], rows[pivot]);
+    for (std::size_t other = 0; other < rows.size (); ++other) {
+      if (other != rank && testBit (rows[other], col)) {
+        for (std::size_t word = 0; word < numWords; ++word) { rows[other][word] ^= rows[rank][word]; }
+      }
+    }
+    pivotCols.push_back (col);
+    ++rank;
+  }
+  for (std::size_t rowNo = rank; rowNo < rows.size (); ++rowNo) {
+    assert (std::all_of (rows[rowNo].begin (), rows[rowNo].end (), [] (std::uint64_t word) { return word == 0; }));
+  }
+
+  // Every solution is one choice of the free buttons, so minimize over the null space.
+  if (freeCols.size () > MAX_FREE_BUTTONS) {
+    throw std::runtime_error ("machine has " + std::to_string (freeCols.size ()) + " free buttons, more than the "
+                              + std::to_string (MAX_FREE_BUTTONS) + " that can be enumerated");
+  }
+  std::size_t best = numButtons + 1;
+  BitRow freeBits (numWords, 0);
+  for (std::uint64_t choice = 0; choice < (std::uint64_t (1) << freeCols.size ()); ++choice) {
+    std::fill (freeBits.begin (), freeBits.end (), 0);
+    for (std::size_t index = 0; index < freeCols.size (); ++index) {
+      if (choice & (std::uint64_t (1) << index)) { setBit (freeBits, freeCols[index]); }
+    }
+    std::size_t presses = std::popcount (choice);
+    for (std::size_t rowNo = 0; rowNo < rank; ++rowNo) {
+      bool pressed = testBit (rows[rowNo], rhsBit) ^ (countCommonBits (rows[rowNo], freeBits) % 2 == 1);
+      if (pressed) { ++presses; }
+    }
+    best = std::min (best, presses);
+  }
+  return best;
 }
 
+// Checks the elimination against the breadth-first search over sets of buttons, machine by machine.
 bool
-myLess2 (const NumPresses& s1, const NumPresses& s2)
+verifyIndicatorLights (const Problem& prob)
 {
-  std::size_t total1 = 0, total2 = 0;
-  for (std::size_t x : s1) { total1 += x; }
-  for (std::size_t x : s2) { total2 += x; }
-  if (total1 < total2) { return true; }
-  else if (total1 > total2) { return false; }
-  else { return s1 < s2; }
+  bool agree = true;
+  for (std::size_t index = 0; index < prob.size (); ++index) {
+    std::size_t searched = configureIndicatorLights (prob[index]).size ();
+    std::size_t eliminated = configureIndicatorLightsFast (prob[index]);
+    if (searched != eliminated) {
+      std::cout << "Machine " << index << ": search found " << searched << " presses, elimination found " << eliminated << "\n";
+      agree = false;
+    }
+  }
+  return agree;
 }
 
-NumPresses
-configureJoltage (const Machine& machine)
+// A row of the joltage system after fraction-free Gauss-Jordan elimination:
+//   divisor * x[pivotCol] = rhs - sum (freeCoefficients[i] * x[freeCols[i]])
+struct JoltageRow
 {
-  std::set<NumPresses, decltype(&myLess2)> frontier (myLess2);
-  std::set<NumPresses> explored;
-  frontier.insert (NumPresses (machine.buttons.size (), 0U));
-  while (!frontier.empty ()) {
-    NumPresses current = *frontier.begin ();
-    frontier.erase (frontier.begin ());
-    explored.insert (current);
-    Joltages result = applyPresses (machine, current);
-    if (result == machine.joltageRequirements) { return current; }
-    for (std::size_t index = 0; index < result.size (); ++index) {
-      if (result[index] > machine.joltageRequirements.at (index)) { continue; }
+  std::size_t pivotCol;
+  long long divisor;
+  long long rhs;
+  std::vector<long long> freeCoefficients;
+};
+
+struct JoltageSystem
+{
+  std::vector<JoltageRow> rows;
+  std::vector<std::size_t> freeCols;
+  // No button can be pressed more times than the smallest counter it increments.
+  std::vector<long long> upperBounds;
+};
+
+void
+reduceByGcd (std::vector<long long>& row)
+{
+  long long divisor = 0;
+  for (long long x : row) { divisor = std::gcd (divisor, x); }
+  if (divisor > 1) {
+    for (long long& x : row) { x /= divisor; }
+  }
+}
+
+JoltageSystem
+eliminateJoltages (const Machine& machine)
+{
+  // Identical buttons are interchangeable, so only their combined number of presses matters.
+  std::vector<Button> buttons = machine.buttons;
+  std::sort (buttons.begin (), buttons.end ());
+  buttons.erase (std::unique (buttons.begin (), buttons.end ()), buttons.end ());
+  const std::size_t numButtons = buttons.size ();
+  const std::size_t numCounters = machine.joltageRequirements.size ();
+  // Each row is the coefficients of every button followed by the required joltage.
+  std::vector<std::vector<long long>> matrix (numCounters, std::vector<long long> (numButtons + 1, 0));
+  for (std::size_t buttonNo = 0; buttonNo < numButtons; ++buttonNo) {
+    for (int counterNo : buttons.at (buttonNo)) {
+      matrix.at (counterNo)[buttonNo] = 1;
     }
-    for (std::size_t buttonNo = 0; buttonNo < machine.buttons.size (); ++buttonNo) {
-      NumPresses next = current;
-      ++(next[buttonNo]);
-      if (explored.count (next) == 0) {
-        frontier.insert (next);
+  }
+  for (std::size_t counterNo = 0; counterNo < numCounters; ++counterNo) {
+    matrix[counterNo][numButtons] = machine.joltageRequirements.at (counterNo);
+  }
+
+  JoltageSystem system;
+  for (std::size_t buttonNo = 0; buttonNo < numButtons; ++buttonNo) {
+    long long bound = std::numeric_limits<long long>::max ();
+    for (int counterNo : buttons.at (buttonNo)) {
+      bound = std::min (bound, (long long)machine.joltageRequirements.at (counterNo));
+    }
+    // A button that touches no counters does nothing, so it is never worth pressing.
+    system.upperBounds.push_back (bound == std::numeric_limits<long long>::max () ? 0 : bound);
+  }
+
+  // Cross-multiplying instead of dividing keeps every entry an exact integer.
+  std::vector<std::size_t> pivotCols;
+  std::size_t rank = 0;
+  for (std::size_t col = 0; col < numButtons; ++col) {
+    std::size_t pivot = rank;
+    while (pivot < numCounters && matrix[pivot][col] == 0) { ++pivot; }
+    if (pivot == numCounters) {
+      system.freeCols.push_back (col);
+      continue;
+    }
+    std::swap (matrix[rank], matrix[pivot]);
+    for (std::size_t other = 0; other < numCounters; ++other) {
+      if (other == rank || matrix[other][col] == 0) { continue; }
+      long long scale = matrix[rank][col];
+      long long factor = matrix[other][col];
+      for (std::size_t index = 0; index <= numButtons; ++index) {
+        matrix[other][index] = matrix[other][index] * scale - matrix[rank][index] * factor;
       }
+      reduceByGcd (matrix[other]);
     }
+    pivotCols.push_back (col);
+    ++rank;
+  }
+  for (std::size_t rowNo = rank; rowNo < numCounters; ++rowNo) {
+    assert (matrix[rowNo][numButtons] == 0);
   }
-  assert (false);
-  return {};
-}
 
-// Tooooo slow, and memory-intensive.  Need to add a good heuristic and do A*.
-std::size_t
-part2 (const Problem& prob)
-{
-  std::size_t total = 0;
-  std::size_t finished = 0;
-  for (const Machine& machine : prob) {
-    NumPresses result = configureJoltage (machine);
-    std::cout << "Solved machine " << finished << " with: ";
-    for (std::size_t x : result) { std::cout << x << " "; }
-    std::cout << "\n";
-    for (std::size_t x : result) { total += x; }
-    ++finished;
+  // Branching on the most constrained free buttons first keeps the search tree narrow.
+  std::sort (system.freeCols.begin (), system.freeCols.end (), [&] (std::size_t a, std::size_t b) {
+    return system.upperBounds[a] < system.upperBounds[b];
+  });
+  for (std::size_t rowNo = 0; rowNo < rank; ++rowNo) {
+    std::vector<long long>& row = matrix[rowNo];
+    if (row[pivotCols[rowNo]] < 0) {
+      for (long long& x : row) { x = -x; }
+    }
+    JoltageRow reduced {pivotCols[rowNo], row[pivotCols[rowNo]], row[numButtons], {}};
+    for (std::size_t freeCol : system.freeCols) {
+      reduced.freeCoefficients.push_back (row[freeCol]);
+    }
+    system.rows.push_back (reduced);
   }
-  return total;
+  return system;
 }
 
-std::size_t
-lamePart2 (const Problem& prob)
+// A dense two-phase simplex for the LP relaxation used to bound the branch and bound.
+// Maximizes objective * x subject to constraints * x <= limits and x >= 0.
+struct LinearProgram
 {
-  std::size_t total = 0;
-  for (const Machine& machine: prob) {
-    z3::context context;
-    z3::optimize optimizer (context);
-    std::vector<z3::expr> buttonVars;
-    std::string prefix = "b";
-    // Create a variable per button.
-    for (std::size_t index = 0; index < machine.buttons.size (); ++index) {
-      std::string name = prefix + std::to_string (index);
-      buttonVars.push_back (context.int_const (name.c_str ()));
-    }
-    // Create an extra constant just because I think it will make building expressions easier.
-    z3::expr zero = context.int_const ("zero");
-    optimizer.add (zero == 0);
-    // Create a constraint per variable saying it may not be negative.
-    for (const auto& var : buttonVars) {
-      optimizer.add (var >= 0);
-    }
-    // Create a constraint for each counter, that it ends up at exactly the rigth nnumber
-    for (std::size_t counterIndex = 0; counterIndex < machine.joltageRequirements.size (); ++counterIndex) {
-      z3::expr partialSum = zero;
-      for (std::size_t buttonIndex = 0; buttonIndex < machine.buttons.size (); ++buttonIndex) {
-        if (machine.buttons.at (buttonIndex).count (counterIndex) != 0) {
-          partialSum = partialSum + buttonVars[buttonIndex];
+  static constexpr double EPSILON = 1e-9;
+  std::size_t numConstraints;
+  std::size_t numVars;
+  std::vector<long> basic;
+  std::vector<long> nonBasic;
+  std::vector<std::vector<double>> tableau;
+
+  LinearProgram (const std::vector<std::vector<double>>& constraints, const std::vector<double>& limits,
+                 const std::vector<double>& objective)
+    : numConstraints {limits.size ()}, numVars {objective.size ()}, basic (numConstraints),
+      nonBasic (numVars + 1), tableau (numConstraints + 2, std::vector<double> (numVars + 2, 0.0))
+  {
+    for (std::size_t row = 0; row < numConstraints; ++row) {
+      for (std::size_t col = 0; col < numVars; ++col) { tableau[row][col] = constraints[row][col]; }
+      basic[row] = numVars + row;
+      tableau[row][numVars] = -1;
+      tableau[row][numVars + 1] = limits[row];
+    }
+    for (std::size_t col = 0; col < numVars; ++col) {
+      nonBasic[col] = col;
+      tableau[numConstraints][col] = -objective[col];
+    }
+    nonBasic[numVars] = -1;
+    tableau[numConstraints + 1][numVars] = 1;
+  }
+
+  void
+  pivot (std::size_t pivotRow, std::size_t pivotCol)
+  {
+    double inverse = 1.0 / tableau[pivotRow][pivotCol];
+    for (std::size_t row = 0; row < numConstraints + 2; ++row) {
+      if (row == pivotRow) { continue; }
+      for (std::size_t col = 0; col < numVars + 2; ++col) {
+        if (col == pivotCol) { continue; }
+        tableau[row][col] -= tableau[pivotRow][col] * tableau[row][pivotCol] * inverse;
+      }
+    }
+    for (std::size_t col = 0; col < numVars + 2; ++col) {
+      if (col != pivotCol) { tableau[pivotRow][col] *= inverse; }
+    }
+    for (std::size_t row = 0; row < numConstraints + 2; ++row) {
+      if (row != pivotRow) { tableau[row][pivotCol] *= -inverse; }
+    }
+    tableau[pivotRow][pivotCol] = inverse;
+    std::swap (basic[pivotRow], nonBasic[pivotCol]);
+  }
+
+  // Returns false if the objective is unbounded.
+  bool
+  simplex (bool phaseOne)
+  {
+    std::size_t objectiveRow = phaseOne ? numConstraints + 1 : numConstraints;
+    while (true) {
+      std::size_t entering = numVars + 1;
+      for (std::size_t col = 0; col <= numVars; ++col) {
+        if (!phaseOne && nonBasic[col] == -1) { continue; }
+        if (entering == numVars + 1 || tableau[objectiveRow][col] < tableau[objectiveRow][entering]
+            || (tableau[objectiveRow][col] == tableau[objectiveRow][entering] && nonBasic[col] < nonBasic[entering])) {
+          entering = col;
         }
       }
-      optimizer.add (partialSum == machine.joltageRequirements.at (counterIndex));
-    }
-    // The expression that I want to minimize:
-    z3::expr totalButtons = zero;
-    for (const auto& var : buttonVars) {
-      totalButtons = totalButtons + var;
-    }
-    // Optimize it
-    optimizer.minimize (totalButtons);
-    if (optimizer.check () == z3::sat) {
-      z3::model results = optimizer.get_model();
-      for (const auto& var : buttonVars) {
-        total += results.eval (var).get_numeral_int();
+      if (tableau[objectiveRow][entering] > -EPSILON) { return true; }
+      std::size_t leaving = numConstraints;
+      for (std::size_t row = 0; row < numConstraints; ++row) {
+        if (tableau[row][entering] < EPSILON) { continue; }
+        if (leaving == numConstraints) { leaving = row; continue; }
+        double ratio = tableau[row][numVars + 1] / tableau[row][entering];
+        double bestRatio = tableau[leaving][numVars + 1] / tableau[leaving][entering];
+        if (ratio < bestRatio || (ratio == bestRatio && basic[row] < basic[leaving])) { leaving = row; }
       }
+      if (leaving == numConstraints) { return false; }
+      pivot (leaving, entering);
     }
-    else {
-      assert (false);
+  }
+
+  // The optimal objective value, or -infinity if the constraints cannot be satisfied.
+  double
+  solve ()
+  {
+    std::size_t lowest = 0;
+    for (std::size_t row = 1; row < numConstraints; ++row) {
+      if (tableau[row][numVars + 1] < tableau[lowest][numVars + 1]) { lowest = row; }
     }
+    if (numConstraints > 0 && tableau[lowest][numVars + 1] < -EPSILON) {
+      pivot (lowest, numVars);
+      if (!simplex (true) || tableau[numConstraints + 1][numVars + 1] < -EPSILON) {
+        return -std::numeric_limits<double>::infinity ();
+      }
+      for (std::size_t row = 0; row < numConstraints; ++row) {
+        if (basic[row] != -1) { continue; }
+        std::size_t entering = 0;
+        for (std::size_t col = 1; col <= numVars; ++col) {
+          if (tableau[row][col] < tableau[row][entering]
+              || (tableau[row][col] == tableau[row][entering] && nonBasic[col] < nonBasic[entering])) {
+            entering = col;
+          }
+        }
+        pivot (row, entering);
+      }
+    }
+    if (!simplex (false)) { return std::numeric_limits<double>::infinity (); }
+    return tableau[numConstraints][numVars + 1];
   }
-  return total;
+};
+
+// Everything the branch and bound needs, precomputed once per machine.
+struct JoltageSearch
+{
+  const JoltageSystem& system;
+  // Scaling every row to a common divisor makes the total presses an exact linear function
+  //   of the free buttons:  scale * total = baseCost + sum (freeCosts[i] * x[freeCols[i]])
+  long long scale;
+  long long baseCost;
+  std::vector<long long> freeCosts;
+  // The least and most that the free buttons from some depth onward can subtract from each row.
+  std::vector<std::vector<long long>> remainingMin;
+  std::vector<std::vector<long long>> remainingMax;
+  std::vector<long long> remainingCostMin;
+  long long best;
+
+  JoltageSearch (const JoltageSystem& sys)
+    : system {sys}, scale {1}, baseCost {0}, best {std::numeric_limits<long long>::max ()}
+  {
+    const std::size_t numFree = system.freeCols.size ();
+    for (const JoltageRow& row : system.rows) { scale = std::lcm (scale, row.divisor); }
+    freeCosts.assign (numFree, scale);
+    for (const JoltageRow& row : system.rows) {
+      long long multiplier = scale / row.divisor;
+      baseCost += row.rhs * multiplier;
+      for (std::size_t index = 0; index < numFree; ++index) {
+        freeCosts[index] -= row.freeCoefficients[index] * multiplier;
+      }
+    }
+    remainingMin.assign (numFree + 1, std::vector<long long> (system.rows.size (), 0));
+    remainingMax.assign (numFree + 1, std::vector<long long> (system.rows.size (), 0));
+    remainingCostMin.assign (numFree + 1, 0);
+    for (std::size_t depth = numFree; depth-- > 0;) {
+      long long bound = system.upperBounds[system.freeCols[depth]];
+      for (std::size_t rowNo = 0; rowNo < system.rows.size (); ++rowNo) {
+        long long extreme = system.rows[rowNo].freeCoefficients[depth] * bound;
+        remainingMin[depth][rowNo] = remainingMin[depth + 1][rowNo] + std::min (0LL, extreme);
+        remainingMax[depth][rowNo] = remainingMax[depth + 1][rowNo] + std::max (0LL, extreme);
+      }
+      remainingCostMin[depth] = remainingCostMin[depth + 1] + std::min (0LL, freeCosts[depth] * bound);
+    }
+  }
+
+  // Solves the LP relaxation over the free buttons from depth onward, with each pivot button
+  //   kept between zero and its upper bound.
+  bool
+  relaxationCouldImprove (std::size_t depth, const std::vector<long long>& numerators, long long cost)
+  {
+    const std::size_t numVars = system.freeCols.size () - depth;
+    std::vector<std::vector<double>> constraints;
+    std::vector<double> limits;
+    for (std::size_t rowNo = 0; rowNo < system.rows.size (); ++rowNo) {
+      const JoltageRow& row = system.rows[rowNo];
+      std::vector<double> coefficients (row.freeCoefficients.begin () + depth, row.freeCoefficients.end ());
+      constraints.push_back (coefficients);
+      limits.push_back (numerators[rowNo]);
+      for (double& x : coefficients) { x = -x; }
+      constraints.push_back (coefficients);
+      limits.push_back (row.divisor * system.upperBounds[row.pivotCol] - numerators[rowNo]);
+    }
+    for (std::size_t var = 0; var < numVars; ++var) {
+      std::vector<double> coefficients (numVars, 0.0);
+      coefficients[var] = 1.0;
+      constraints.push_back (coefficients);
+      limits.push_back (system.upperBounds[system.freeCols[depth + var]]);
+    }
+    std::vector<double> objective;
+    for (std::size_t var = 0; var < numVars; ++var) { objective.push_back (-freeCosts[depth + var]); }
+    double cheapest = -LinearProgram (constraints, limits, objective).solve ();
+    if (cheapest == std::numeric_limits<double>::infinity ()) { return false; }
+    if (best == std::numeric_limits<long long>::max ()) { return true; }
+    return cost + cheapest <= (best - 1) * scale + 1e-6 * scale;
+  }
+
+  // numerators[i] is row i's rhs minus the contributions of the free buttons chosen so far.
+  void
+  search (std::size_t depth, std::vector<long long>& numerators, long long cost)
+  {
+    if (best != std::numeric_limits<long long>::max () && cost + remainingCostMin[depth] > (best - 1) * scale) { return; }
+    for (std::size_t rowNo = 0; rowNo < system.rows.size (); ++rowNo) {
+      const JoltageRow& row = system.rows[rowNo];
+      long long most = numerators[rowNo] - remainingMin[depth][rowNo];
+      long long least = numerators[rowNo] - remainingMax[depth][rowNo];
+      if (most < 0 || least > row.divisor * system.upperBounds[row.pivotCol]) { return; }
+    }
+    if (depth + 1 < system.freeCols.size () && !relaxationCouldImprove (depth, numerators, cost)) { return; }
+    if (depth == system.freeCols.size ()) {
+      for (std::size_t rowNo = 0; rowNo < system.rows.size (); ++rowNo) {
+        if (numerators[rowNo] % system.rows[rowNo].divisor != 0) { return; }
+      }
+      best = cost / scale;
+      return;
+    }
+    long long bound = system.upperBounds[system.freeCols[depth]];
+    // Try the cheap end of this button's range first so that good solutions are found early.
+    bool ascending = freeCosts[depth] >= 0;
+    for (long long step = 0; step <= bound; ++step) {
+      long long presses = ascending ? step : bound - step;
+      for (std::size_t rowNo = 0; rowNo < system.rows.size (); ++rowNo) {
+        numerators[rowNo] -= system.rows[rowNo].freeCoefficients[depth] * presses;
+      }
+      search (depth + 1, numerators, cost + freeCosts[depth] * presses);
+      for (std::size_t rowNo = 0; rowNo < system.rows.size (); ++rowNo) {
+        numerators[rowNo] += system.rows[rowNo].freeCoefficients[depth] * presses;
+      }
+    }
+  }
+};
+
+std::size_t
+configureJoltageFast (const Machine& machine)
+{
+  JoltageSystem system = eliminateJoltages (machine);
+  JoltageSearch search (system);
+  std::vector<long long> numerators;
+  for (const JoltageRow& row : system.rows) { numerators.push_back (row.rhs); }
+  search.search (0, numerators, search.baseCost);
+  assert (search.best != std::numeric_limits<long long>::max ());
+  return search.best;
+}
+
+// Machines are independent, so hand them out to worker threads one at a time.
+std::size_t
+solveAllMachines (const Problem& prob, std::size_t (*solve)(const Machine&))
+{
+  std::vector<std::size_t> results (prob.size (), 0);
+  forEachIndex (prob.size (), [&] (std::size_t index, unsigned int) {
+    results[index] = solve (prob[index]);
+  });
+  return std::accumulate (results.begin (), results.end (), std::size_t (0));
 }
 
 int
 main (int argc, char* argv[])
 {
   Problem prob = getInput ();
-  std::cout << part1 (prob) << "\n";
-  std::cout << lamePart2 (prob) << "\n";
+  if (argc > 1 && std::strcmp (argv[1], "--verify") == 0) {
+    bool agree = verifyIndicatorLights (prob);
+    std::cout << (agree ? "Indicator lights agree\n" : "Indicator lights disagree\n");
+    return agree ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  std::cout << solveAllMachines (prob, configureIndicatorLightsFast) << "\n";
+  std::cout << solveAllMachines (prob, configureJoltageFast) << "\n";
   return EXIT_SUCCESS;
 }
 
@@ -8,6 +8,13 @@
 #include <vector>
 #include <cassert>
 #include <regex>
+#include <cstdint>
+#include <bit>
+#include <set>
+#include <algorithm>
+#include <stdexcept>
+
+#include "utilities.hpp"
 
 const char FILLED = '#';
 const char EMPTY = '.';
@@ -46,6 +53,11 @@ getInput ()
     }
     std::getline (std::cin, line0);
     assert (line0.size () == 0);
+    // Orientations are trimmed down to their first filled row and column, which an empty shape lacks.
+    if (std::all_of (shape.begin (), shape.end (), [] (const std::array<char, 3>& row) {
+          return std::count (row.begin (), row.end (), FILLED) == 0; })) {
+      throw std::runtime_error ("present shape " + std::to_string (prob.shapes.size ()) + " has no filled cells");
+    }
     prob.shapes.push_back (shape);
   }
   assert (prob.shapes.size () < 10);
@@ -98,30 +110,236 @@ isTriviallyTooSmall (const Problem& prob, const Region& region)
   return (region.width * region.length < totalSquares);
 }
 
-void
-explorePart1 (const Problem& prob)
+// One orientation of a shape, with each row as a bitmask (bit c for column c).  Empty rows and
+//   columns on the top and left are trimmed, so the first filled cell is in row 0.
+struct Orientation
 {
-  std::size_t easyYes = 0, easyNo = 0, hard = 0;
-  for (const Region& region : prob.regions) {
-    if (isTriviallyBigEnough (prob, region)) {
-      ++easyYes;
+  std::array<std::uint64_t, 3> rows;
+  std::size_t height;
+  std::size_t width;
+  std::size_t firstCol;
+  auto operator<=> (const Orientation& other) const = default;
+};
+
+Orientation
+makeOrientation (const PresentShape& shape)
+{
+  std::array<std::uint64_t, 3> rows {0, 0, 0};
+  for (std::size_t row = 0; row < 3; ++row) {
+    for (std::size_t col = 0; col < 3; ++col) {
+      if (shape[row][col] == FILLED) { rows[row] |= std::uint64_t (1) << col; }
     }
-    else if (isTriviallyTooSmall (prob, region)) {
-      ++easyNo;
+  }
+  while (rows[0] == 0) { rows = {rows[1], rows[2], 0}; }
+  while (((rows[0] | rows[1] | rows[2]) & 1) == 0) {
+    for (std::uint64_t& row : rows) { row >>= 1; }
+  }
+  Orientation result {rows, 0, 0, 0};
+  for (std::size_t row = 0; row < 3; ++row) {
+    if (rows[row] != 0) { result.height = row + 1; }
+    result.width = std::max<std::size_t> (result.width, std::bit_width (rows[row]));
+  }
+  result.firstCol = std::countr_zero (rows[0]);
+  return result;
+}
+
+// Every distinct rotation and reflection of a shape.
+std::vector<Orientation>
+getOrientations (PresentShape shape)
+{
+  std::set<Orientation> unique;
+  for (std::size_t reflection = 0; reflection < 2; ++reflection) {
+    for (std::size_t rotation = 0; rotation < 4; ++rotation) {
+      unique.insert (makeOrientation (shape));
+      PresentShape rotated;
+      for (std::size_t row = 0; row < 3; ++row) {
+        for (std::size_t col = 0; col < 3; ++col) { rotated[col][2 - row] = shape[row][col]; }
+      }
+      shape = rotated;
     }
-    else {
-      ++hard;
+    for (std::array<char, 3>& row : shape) { std::swap (row[0], row[2]); }
+  }
+  return {unique.begin (), unique.end ()};
+}
+
+// Precomputed facts about each shape, shared by every region.
+struct ShapeInfo
+{
+  std::vector<Orientation> orientations;
+  std::size_t area;
+  // On a checkerboard, the fewest cells of either colour that any placement of this shape covers.
+  std::size_t minPerColour;
+};
+
+std::vector<ShapeInfo>
+getShapeInfo (const Problem& prob)
+{
+  std::vector<ShapeInfo> infos;
+  for (const PresentShape& shape : prob.shapes) {
+    ShapeInfo info {getOrientations (shape), 0, 0};
+    std::size_t evenCells = 0;
+    for (std::size_t row = 0; row < 3; ++row) {
+      for (std::size_t col = 0; col < 3; ++col) {
+        if (shape[row][col] == FILLED) {
+          ++info.area;
+          if ((row + col) % 2 == 0) { ++evenCells; }
+        }
+      }
+    }
+    // Rotating and reflecting a shape permutes its cells without changing their colour balance.
+    info.minPerColour = std::min (evenCells, info.area - evenCells);
+    infos.push_back (info);
+  }
+  return infos;
+}
+
+// Backtracking search that fills the region in row-major order.  The first empty cell must either be
+//   the first cell of some placed shape, or be left empty for good (a dead cell).
+class PackingSearch
+{
+public:
+  PackingSearch (const std::vector<ShapeInfo>& shapes, const Region& region)
+    : m_shapes {shapes}, m_width {region.width}, m_length {region.length}, m_remaining {region.counts},
+      m_board {}, m_neededArea {0}, m_neededPerColour {0}
+  {
+    // The board is stored one row per word, so make sure rows are the short side.
+    if (m_width > m_length) { std::swap (m_width, m_length); }
+    if (m_width > 64) {
+      throw std::runtime_error ("region " + std::to_string (m_width) + "x" + std::to_string (m_length)
+                                + " is too wide for one word per row");
+    }
+    m_board.assign (m_length, 0);
+    for (std::size_t shapeIndex = 0; shapeIndex < m_shapes.size (); ++shapeIndex) {
+      m_neededArea += m_shapes[shapeIndex].area * m_remaining[shapeIndex];
+      m_neededPerColour += m_shapes[shapeIndex].minPerColour * m_remaining[shapeIndex];
     }
-  } 
-  std::cout << easyYes << " definitely yes, " << easyNo << " definitely no, " << hard << " maybe\n";
+    std::size_t cells = m_width * m_length;
+    m_freePerColour = {(cells + 1) / 2, cells / 2};
+  }
+
+  bool
+  solve ()
+  {
+    if (m_neededArea > m_width * m_length) { return false; }
+    return search (0, m_width * m_length - m_neededArea);
+  }
+
+private:
+  bool
+  isFilled (std::size_t row, std::size_t col) const
+  {
+    return (m_board[row] >> col) & 1;
+  }
+
+  bool
+  fits (const Orientation& orientation, std::size_t row, std::size_t left) const
+  {
+    if (row + orientation.height > m_length || left + orientation.width > m_width) { return false; }
+    for (std::size_t offset = 0; offset < orientation.height; ++offset) {
+      if (m_board[row + offset] & (orientation.rows[offset] << left)) { return false; }
+    }
+    return true;
+  }
+
+  // Places or removes a shape, keeping the checkerboard counts current.
+  void
+  toggle (const Orientation& orientation, std::size_t row, std::size_t left, bool placing)
+  {
+    for (std::size_t offset = 0; offset < orientation.height; ++offset) {
+      std::uint64_t bits = orientation.rows[offset] << left;
+      m_board[row + offset] ^= bits;
+      std::size_t even = std::popcount (bits & colourMask (row + offset));
+      std::size_t odd = std::popcount (bits) - even;
+      if (placing) { m_freePerColour[0] -= even; m_freePerColour[1] -= odd; }
+      else { m_freePerColour[0] += even; m_freePerColour[1] += odd; }
+    }
+  }
+
+  // The columns of a row whose cells have (row + col) even.
+  static std::uint64_t
+  colourMask (std::size_t row)
+  {
+    const std::uint64_t EVEN_COLUMNS = 0x5555555555555555ULL;
+    return (row % 2 == 0) ? EVEN_COLUMNS : ~EVEN_COLUMNS;
+  }
+
+  // slack is how many more cells may be left empty.
+  bool
+  search (std::size_t cell, std::size_t slack)
+  {
+    if (m_neededArea == 0) { return true; }
+    if (m_neededPerColour > m_freePerColour[0] || m_neededPerColour > m_freePerColour[1]) { return false; }
+    while (cell < m_width * m_length && isFilled (cell / m_width, cell % m_width)) { ++cell; }
+    if (cell == m_width * m_length) { return false; }
+    std::size_t row = cell / m_width;
+    std::size_t col = cell % m_width;
+
+    for (std::size_t shapeIndex = 0; shapeIndex < m_shapes.size (); ++shapeIndex) {
+      if (m_remaining[shapeIndex] == 0) { continue; }
+      const ShapeInfo& shape = m_shapes[shapeIndex];
+      for (const Orientation& orientation : shape.orientations) {
+        if (orientation.firstCol > col) { continue; }
+        std::size_t left = col - orientation.firstCol;
+        if (!fits (orientation, row, left)) { continue; }
+        toggle (orientation, row, left, true);
+        --m_remaining[shapeIndex];
+        m_neededArea -= shape.area;
+        m_neededPerColour -= shape.minPerColour;
+        bool found = search (cell + 1, slack);
+        m_neededPerColour += shape.minPerColour;
+        m_neededArea += shape.area;
+        ++m_remaining[shapeIndex];
+        toggle (orientation, row, left, false);
+        if (found) { return true; }
+      }
+    }
+
+    if (slack == 0) { return false; }
+    std::uint64_t bit = std::uint64_t (1) << col;
+    std::size_t colour = (colourMask (row) & bit) ? 0 : 1;
+    m_board[row] |= bit;
+    --m_freePerColour[colour];
+    bool found = search (cell + 1, slack - 1);
+    ++m_freePerColour[colour];
+    m_board[row] &= ~bit;
+    return found;
+  }
+
+  const std::vector<ShapeInfo>& m_shapes;
+  std::size_t m_width;
+  std::size_t m_length;
+  std::vector<std::size_t> m_remaining;
+  std::vector<std::uint64_t> m_board;
+  std::size_t m_neededArea;
+  std::size_t m_neededPerColour;
+  std::array<std::size_t, 2> m_freePerColour;
+};
+
+bool
+canFit (const Problem& prob, const std::vector<ShapeInfo>& shapes, const Region& region)
+{
+  if (isTriviallyBigEnough (prob, region)) { return true; }
+  if (isTriviallyTooSmall (prob, region)) { return false; }
+  return PackingSearch (shapes, region).solve ();
+}
+
+// Regions are independent, so hand them out to worker threads one at a time.
+std::size_t
+part1 (const Problem& prob)
+{
+  std::vector<ShapeInfo> shapes = getShapeInfo (prob);
+  std::vector<char> fits (prob.regions.size (), false);
+  forEachIndex (prob.regions.size (), [&] (std::size_t index, unsigned int) {
+    fits[index] = canFit (prob, shapes, prob.regions[index]);
+  });
+  return std::count (fits.begin (), fits.end (), true);
 }
 
 int
 main (int argc, char* argv[])
 {
   Problem prob = getInput ();
-  explorePart1 (prob);
-  // Maybe we'll write an algorithm for solving the "maybe" cases later ...
+  std::cout << part1 (prob) << "\n";
   return EXIT_SUCCESS;
 }
 
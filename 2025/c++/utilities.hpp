@@ -0,0 +1,45 @@
+#ifndef AOC_2025_UTILITIES_HPP
+#define AOC_2025_UTILITIES_HPP
+/// \file utilities.hpp
+/// \author Chad Hogg
+/// \brief Some code shared by more than one day of Advent Of Code 2025.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// How many threads a parallel loop should use: one per hardware thread, or 1 if that is unknown.
+inline unsigned int
+workerCount ()
+{
+  return std::max (1U, std::thread::hardware_concurrency ());
+}
+
+// Calls work (index, thread) once for every index in [0, count), with thread in [0, threads).
+// Each thread takes the next unclaimed index, so slow indices do not hold up the rest.
+// Calls with the same thread number never run at the same time.
+template<typename Work>
+void
+forEachIndex (std::size_t count, Work work, unsigned int threads = workerCount ())
+{
+  std::atomic<std::size_t> next = 0;
+  auto loop = [&] (unsigned int thread) {
+    for (std::size_t index = next++; index < count; index = next++) {
+      work (index, thread);
+    }
+  };
+  if (threads <= 1 || count <= 1) {
+    loop (0);
+    return;
+  }
+  std::vector<std::thread> workers;
+  for (unsigned int thread = 1; thread < threads; ++thread) {
+    workers.emplace_back (loop, thread);
+  }
+  loop (0);
+  for (std::thread& worker : workers) { worker.join (); }
+}
+
+#endif//AOC_2025_UTILITIES_HPP